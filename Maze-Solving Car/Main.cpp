@@ -24,6 +24,7 @@ private:
 	int xSize; // Width of window in blocks
 	int ySize; //  Height of window in blocks
 	bool rPressed = false;
+	bool cPressed = false;
 	bool spacePressed = false;
 	bool mouseClicked = false;
 	bool showGrid = false;
@@ -44,6 +45,8 @@ public:
 	void setSpacePressed(bool newStatus);
 	bool getRPressed(void);
 	void setRPressed(bool newStatus);
+	bool getCPressed(void);
+	void setCPressed(bool newStatus);
 	int shouldClose(void);
 	void drawBorder(void);
 	void drawGrid(void);
@@ -100,6 +103,7 @@ void GLFWWrapper::key_callback(GLFWwindow* window, int key, int scancode, int ac
 {
 	GLFWWrapper* wrapper = (GLFWWrapper*)glfwGetWindowUserPointer(window);
 	if (key == GLFW_KEY_R && action == GLFW_PRESS) wrapper->rPressed = true;
+	if (key == GLFW_KEY_C && action == GLFW_PRESS) wrapper->cPressed = true;
 	if (key == GLFW_KEY_Q && action == GLFW_PRESS)	glfwSetWindowShouldClose(window, GLFW_TRUE);
 	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) wrapper->spacePressed = true;
 	if (key == GLFW_KEY_G && action == GLFW_PRESS) wrapper->showGrid ^= 1;
@@ -246,6 +250,16 @@ void GLFWWrapper::setRPressed(bool newStatus)
 	this->rPressed = newStatus;
 }
 
+bool GLFWWrapper::getCPressed(void)
+{
+	return this->cPressed;
+}
+
+void GLFWWrapper::setCPressed(bool newStatus)
+{
+	this->cPressed = newStatus;
+}
+
 bool validateInt(std::string input)
 {
 	bool isValid = true;
@@ -261,6 +275,16 @@ bool validateInt(std::string input)
 	return isValid;
 }
 
+void addCentreGoal(Maze* maze) // Micromouse style, the four middle spaces all count as the goal. Done after generating so no walls land on them.
+{
+	int centreX = maze->getXSize() / 2 - 1;
+	int centreY = maze->getYSize() / 2 - 1;
+	maze->addGoal(centreX, centreY);
+	maze->addGoal(centreX + 1, centreY);
+	maze->addGoal(centreX, centreY + 1);
+	maze->addGoal(centreX + 1, centreY + 1);
+}
+
 std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 {
 	int mazeXSize = -1, mazeYSize = -1, goalX = -1, goalY = -1, generator = -1, solver = -1;
@@ -322,7 +346,7 @@ std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 	while (generator == -1)
 	{
 		{
-			std::cout << "Please select a maze generation option.\nEnter 1 for Recursive Subdivider.\n";
+			std::cout << "Please select a maze generation option.\nEnter 1 for Recursive Subdivider.\nEnter 2 for Recursive Subdivider with terrain (mud, ramps and slow zones).\n";
 			std::string inputString;
 			std::cin >> inputString;
 			if (validateInt(inputString))
@@ -332,6 +356,8 @@ std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 				{
 				case 1:
 					break;
+				case 2:
+					break;
 				default:
 					generator = -1;
 				}
@@ -341,7 +367,7 @@ std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 	while (solver == -1)
 	{
 		{
-			std::cout << "Please select a maze solving option.\nEnter 1 for Flood Fill.\nEnter 2 for Dijkstra.\nEnter 3 for A*\n";
+			std::cout << "Please select a maze solving option.\nEnter 1 for Flood Fill.\nEnter 2 for Dijkstra.\nEnter 3 for A*.\nEnter 4 for Bidirectional BFS.\nEnter 5 for Jump Point Search.\nEnter 6 for Contracted A*.\nEnter 7 for Dead-end Filling.\nEnter 8 for Goal Distance Field.\nEnter 9 for D* Lite.\nEnter 10 for Flood Fill (exploring unknown walls).\nEnter 11 for Explore then Speed Run.\nEnter 12 for Wall Follower (left hand).\nEnter 13 for Wall Follower (right hand).\nEnter 14 for Pledge.\nEnter 15 for Tremaux.\nEnter 16 for Fixed-size Flood Fill (16x16 or 32x32 mazes only).\nEnter 17 for Hierarchical A* (HPA*).\nEnter 18 for Tree Route (perfect mazes, LCA index).\nEnter 19 for Bit-parallel BFS.\nEnter 20 for Parallel BFS (all cores).\nEnter 21 for Delta-stepping (weighted terrain, all cores).\nEnter 22 for Portfolio (race several solvers).\nEnter 23 for IDA* (low memory).\nEnter 24 for Anytime A* (ARA*, improves while driving).\nEnter 25 for Stepped A* (shows the search as it runs, C cancels).\n";
 			std::string inputString;
 			std::cin >> inputString;
 			if (validateInt(inputString))
@@ -355,6 +381,55 @@ std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 					break;
 				case 3:
 					break;
+				case 4:
+					break;
+				case 5:
+					break;
+				case 6:
+					break;
+				case 7:
+					break;
+				case 8:
+					break;
+				case 9:
+					break;
+				case 10:
+					break;
+				case 11:
+					break;
+				case 12:
+					break;
+				case 13:
+					break;
+				case 14:
+					break;
+				case 15:
+					break;
+				case 16:
+					if ((mazeXSize != 16 || mazeYSize != 16) && (mazeXSize != 32 || mazeYSize != 32))
+					{
+						std::cout << "The fixed-size flood fill only works on 16x16 or 32x32 mazes." << std::endl;
+						solver = -1;
+					}
+					break;
+				case 17:
+					break;
+				case 18:
+					break;
+				case 19:
+					break;
+				case 20:
+					break;
+				case 21:
+					break;
+				case 22:
+					break;
+				case 23:
+					break;
+				case 24:
+					break;
+				case 25:
+					break;
 				default:
 					solver = -1;
 				}
@@ -364,11 +439,37 @@ std::tuple<int, int, int, int, int, int> getMazeParameters(void)
 	return std::make_tuple(mazeXSize, mazeYSize, goalX, goalY, generator, solver);
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
+	if (argc > 1 && std::string(argv[1]) == "--benchmark-fixed") // Cycle counts for the firmware flood fill, without opening a window
+	{
+		benchmarkFloodFillFixed<16, 16>(1000);
+		benchmarkFloodFillFixed<32, 32>(1000);
+		return 0;
+	}
 	bool paused = true; // While this is true, the car isn't moving
+	bool diagonalMoves = false; // --diagonal lets Dijkstra and A* cut diagonally across open spaces
+	bool centreGoal = false; // --centre-goal adds the middle 2x2 as goals on top of the one entered
+	int startX = 0, startY = 0; // --start X Y puts the car somewhere other than the corner
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "--diagonal") diagonalMoves = true;
+		if (std::string(argv[i]) == "--centre-goal") centreGoal = true;
+		if (std::string(argv[i]) == "--start")
+		{
+			if (i + 2 >= argc || !validateInt(argv[i + 1]) || !validateInt(argv[i + 2]))
+			{
+				std::cout << "CRITICAL ERROR: --start needs an X and a Y co-ordinate!" << std::endl;
+				return 1;
+			}
+			startX = std::atoi(argv[i + 1]);
+			startY = std::atoi(argv[i + 2]);
+			i += 2;
+		}
+	}
 	auto [mazeXSize, mazeYSize, goalX, goalY, mazeGenerator, mazeSolver] = getMazeParameters();
 	Maze* maze = new Maze(mazeXSize, mazeYSize, goalX, goalY);
+	if (diagonalMoves) maze->setConnectivity(EIGHT_CONNECTED);
 	std::chrono::high_resolution_clock::time_point time1 = std::chrono::high_resolution_clock::now();
 	std::string solverName;
 	switch (mazeGenerator)
@@ -376,10 +477,20 @@ int main(void)
 	case 1:
 		maze->setGenerator(new RecursiveSubdivider(maze));
 		break;
+	case 2:
+		maze->setGenerator(new TerrainSubdivider(maze));
+		break;
 	default:
 		std::cout << "CRITICAL ERROR: Invalid maze generation method specified!" << std::endl;
 		return 1;
 	}
+	if (centreGoal) addCentreGoal(maze);
+	if (startX >= maze->getXSize() || startY >= maze->getYSize())
+	{
+		std::cout << "CRITICAL ERROR: The start is outside the maze!" << std::endl;
+		return 1;
+	}
+	maze->setStart(startX, startY);
 	std::chrono::high_resolution_clock::time_point time2 = std::chrono::high_resolution_clock::now();
 	std::chrono::duration<double> timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(time2 - time1);
 	double mazeGenTime = timeSpan.count();
@@ -398,6 +509,95 @@ int main(void)
 		maze->setSolver(new MazeSolve::AStar(maze));
 		solverName = "Astar";
 		break;
+	case 4:
+		maze->setSolver(new MazeSolve::BidirectionalBFS(maze));
+		solverName = "BidirectionalBFS";
+		break;
+	case 5:
+		maze->setSolver(new MazeSolve::JumpPointSearch(maze));
+		solverName = "JumpPointSearch";
+		break;
+	case 6:
+		maze->setSolver(new MazeSolve::ContractedAStar(maze));
+		solverName = "ContractedAStar";
+		break;
+	case 7:
+		maze->setSolver(new MazeSolve::DeadEndFilling(maze));
+		solverName = "DeadEndFilling";
+		break;
+	case 8:
+		maze->setSolver(new MazeSolve::DistanceFieldSolver(maze));
+		solverName = "DistanceFieldSolver";
+		break;
+	case 9:
+		maze->setSolver(new MazeSolve::DStarLite(maze));
+		solverName = "DStarLite";
+		break;
+	case 10:
+		maze->setSolver(new MazeSolve::FloodFill(maze, true));
+		solverName = "FloodFillExploring";
+		break;
+	case 11:
+		maze->setSolver(new MazeSolve::ExploreThenSpeedRun(maze));
+		solverName = "ExploreThenSpeedRun";
+		break;
+	case 12:
+		maze->setSolver(new MazeSolve::WallFollower(maze, true));
+		solverName = "WallFollowerLeft";
+		break;
+	case 13:
+		maze->setSolver(new MazeSolve::WallFollower(maze, false));
+		solverName = "WallFollowerRight";
+		break;
+	case 14:
+		maze->setSolver(new MazeSolve::Pledge(maze));
+		solverName = "Pledge";
+		break;
+	case 15:
+		maze->setSolver(new MazeSolve::Tremaux(maze));
+		solverName = "Tremaux";
+		break;
+	case 16:
+		if (maze->getXSize() == 32 && maze->getYSize() == 32) maze->setSolver(new MazeSolve::FloodFillFixed<32, 32>(maze));
+		else maze->setSolver(new MazeSolve::FloodFillFixed<16, 16>(maze)); // getMazeParameters only lets 16x16 through otherwise
+		solverName = "FloodFillFixed";
+		break;
+	case 17:
+		maze->setSolver(new MazeSolve::HierarchicalAStar(maze));
+		solverName = "HierarchicalAStar";
+		break;
+	case 18:
+		maze->setSolver(new MazeSolve::TreePathSolver(maze));
+		solverName = "TreePathSolver";
+		break;
+	case 19:
+		maze->setSolver(new MazeSolve::BitParallelBFS(maze));
+		solverName = "BitParallelBFS";
+		break;
+	case 20:
+		maze->setSolver(new MazeSolve::ParallelBFS(maze));
+		solverName = "ParallelBFS";
+		break;
+	case 21:
+		maze->setSolver(new MazeSolve::DeltaStepping(maze));
+		solverName = "DeltaStepping";
+		break;
+	case 22:
+		maze->setSolver(new MazeSolve::PortfolioSolver(maze));
+		solverName = "PortfolioSolver";
+		break;
+	case 23:
+		maze->setSolver(new MazeSolve::IDAStar(maze));
+		solverName = "IDAStar";
+		break;
+	case 24:
+		maze->setSolver(new MazeSolve::AnytimeAStar(maze));
+		solverName = "AnytimeAStar";
+		break;
+	case 25:
+		maze->setSolver(new MazeSolve::SteppedAStar(maze));
+		solverName = "SteppedAStar";
+		break;
 	default:
 		std::cout << "CRITICAL ERROR: Invalid maze generation method specified!" << std::endl;
 		return 1;
@@ -409,6 +609,7 @@ int main(void)
 	std::cout << glfwGetVersionString() << std::endl;
 	while (!mazeWindow->shouldClose())
 	{
+		MazeSolve::SteppedSolver* steppedSolver = dynamic_cast<MazeSolve::SteppedSolver*>(maze->GetCar()->getMazeSolver()); // NULL unless the search runs a slice per frame
 		for (int i = 0; i < maze->getXSize(); i++)
 		{
 			for (int j = 0; j < maze->getYSize(); j++)
@@ -418,6 +619,14 @@ int main(void)
 				if (blockColour == "Red") glColor3f(1.0, 0.0, 0.0);
 				if (blockColour == "Green") glColor3f(0.0, 1.0, 0.0);
 				if (blockColour == "Black") glColor3f(0.0, 0.0, 0.0);
+				if (blockColour == "Brown") glColor3f(0.55, 0.35, 0.15);
+				if (blockColour == "Orange") glColor3f(1.0, 0.6, 0.0);
+				if (blockColour == "Grey") glColor3f(0.6, 0.6, 0.6);
+				if (steppedSolver != NULL && blockColour == "White") // Shade what the search has got to so far
+				{
+					if (steppedSolver->getMark(i, j) == MazeSolve::SteppedSolver::VISITED) glColor3f(0.7, 0.85, 1.0);
+					if (steppedSolver->getMark(i, j) == MazeSolve::SteppedSolver::FRONTIER) glColor3f(1.0, 1.0, 0.6);
+				}
 				mazeWindow->drawSquare(i, j);
 			}
 		}
@@ -432,6 +641,11 @@ int main(void)
 			paused = !paused;
 			mazeWindow->setSpacePressed(false);
 		}
+		if (mazeWindow->getCPressed())
+		{
+			if (steppedSolver != NULL) steppedSolver->cancel();
+			mazeWindow->setCPressed(false);
+		}
 		if (mazeWindow->getMouseClicked()) // Debug function - allows for editing the maze in real-time
 		{
 			try
@@ -459,16 +673,27 @@ int main(void)
 			delete mazeWindow;
 			auto [mazeXSize, mazeYSize, goalX, goalY, mazeGenerator, mazeSolver] = getMazeParameters();
 			maze = new Maze(mazeXSize, mazeYSize, goalX, goalY);
+			if (diagonalMoves) maze->setConnectivity(EIGHT_CONNECTED);
 			std::chrono::high_resolution_clock::time_point time1 = std::chrono::high_resolution_clock::now();
 			switch (mazeGenerator)
 			{
 			case 1:
 				maze->setGenerator(new RecursiveSubdivider(maze));
 				break;
+			case 2:
+				maze->setGenerator(new TerrainSubdivider(maze));
+				break;
 			default:
 				std::cout << "CRITICAL ERROR: Invalid maze generation method specified!" << std::endl;
 				return 1;
 			}
+			if (centreGoal) addCentreGoal(maze);
+			if (startX >= maze->getXSize() || startY >= maze->getYSize())
+			{
+				std::cout << "CRITICAL ERROR: The start is outside the maze!" << std::endl;
+				return 1;
+			}
+			maze->setStart(startX, startY);
 			std::chrono::high_resolution_clock::time_point time2 = std::chrono::high_resolution_clock::now();
 			std::chrono::duration<double> timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(time2 - time1);
 			mazeGenTime = timeSpan.count();
@@ -484,6 +709,73 @@ int main(void)
 			case 3:
 				maze->setSolver(new MazeSolve::AStar(maze));
 				break;
+			case 4:
+				maze->setSolver(new MazeSolve::BidirectionalBFS(maze));
+				break;
+			case 5:
+				maze->setSolver(new MazeSolve::JumpPointSearch(maze));
+				break;
+			case 6:
+				maze->setSolver(new MazeSolve::ContractedAStar(maze));
+				break;
+			case 7:
+				maze->setSolver(new MazeSolve::DeadEndFilling(maze));
+				break;
+			case 8:
+				maze->setSolver(new MazeSolve::DistanceFieldSolver(maze));
+				break;
+			case 9:
+				maze->setSolver(new MazeSolve::DStarLite(maze));
+				break;
+			case 10:
+				maze->setSolver(new MazeSolve::FloodFill(maze, true));
+				break;
+			case 11:
+				maze->setSolver(new MazeSolve::ExploreThenSpeedRun(maze));
+				break;
+			case 12:
+				maze->setSolver(new MazeSolve::WallFollower(maze, true));
+				break;
+			case 13:
+				maze->setSolver(new MazeSolve::WallFollower(maze, false));
+				break;
+			case 14:
+				maze->setSolver(new MazeSolve::Pledge(maze));
+				break;
+			case 15:
+				maze->setSolver(new MazeSolve::Tremaux(maze));
+				break;
+			case 16:
+				if (maze->getXSize() == 32 && maze->getYSize() == 32) maze->setSolver(new MazeSolve::FloodFillFixed<32, 32>(maze));
+				else maze->setSolver(new MazeSolve::FloodFillFixed<16, 16>(maze));
+				break;
+			case 17:
+				maze->setSolver(new MazeSolve::HierarchicalAStar(maze));
+				break;
+			case 18:
+				maze->setSolver(new MazeSolve::TreePathSolver(maze));
+				break;
+			case 19:
+				maze->setSolver(new MazeSolve::BitParallelBFS(maze));
+				break;
+			case 20:
+				maze->setSolver(new MazeSolve::ParallelBFS(maze));
+				break;
+			case 21:
+				maze->setSolver(new MazeSolve::DeltaStepping(maze));
+				break;
+			case 22:
+				maze->setSolver(new MazeSolve::PortfolioSolver(maze));
+				break;
+			case 23:
+				maze->setSolver(new MazeSolve::IDAStar(maze));
+				break;
+			case 24:
+				maze->setSolver(new MazeSolve::AnytimeAStar(maze));
+				break;
+			case 25:
+				maze->setSolver(new MazeSolve::SteppedAStar(maze));
+				break;
 			default:
 				std::cout << "CRITICAL ERROR: Invalid maze solving method specified!" << std::endl;
 				return 1;
@@ -497,7 +789,7 @@ int main(void)
 		if (!paused)
 		{
 			maze->Step();
-			if (maze->GetCar()->GetX() == maze->getGoalX() && maze->GetCar()->GetY() == maze->getGoalY())
+			if (maze->isGoal(maze->GetCar()->GetX(), maze->GetCar()->GetY()))
 			{
 				time2 = std::chrono::high_resolution_clock::now();
 				timeSpan = std::chrono::duration_cast<std::chrono::duration<double>>(time2 - time1);
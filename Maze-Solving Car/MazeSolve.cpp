@@ -1,7 +1,132 @@
 #include "MazeSolve.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace MazeSolve;
 
+static int lowestSetBit(uint64_t word) // word must be non-zero
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)word)) return (int)index;
+	_BitScanForward(&index, (unsigned long)(word >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+static int highestSetBit(uint64_t word) // word must be non-zero
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, word);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(word >> 32))) return (int)index + 32;
+	_BitScanReverse(&index, (unsigned long)word);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(word);
+#endif
+}
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define HAS_AVX2_PATH
+#define AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAS_AVX2_PATH
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef HAS_AVX2_PATH
+// One BitParallelBFS row, four words at a time. Every pointer points at word 1 of its padded row, so the loads at w - 1 and w + 1 land
+// in the padding words at either end.
+AVX2_TARGET static bool expandRowAvx2(const uint64_t* frontierRow, const uint64_t* frontierAbove, const uint64_t* frontierBelow, const uint64_t* openRow, uint64_t* visitedRow, uint64_t* nextRow, int words)
+{
+	__m256i any = _mm256_setzero_si256();
+	for (int w = 0; w < words; w += 4)
+	{
+		__m256i current = _mm256_loadu_si256((const __m256i*)(frontierRow + w));
+		__m256i lower = _mm256_loadu_si256((const __m256i*)(frontierRow + w - 1));
+		__m256i higher = _mm256_loadu_si256((const __m256i*)(frontierRow + w + 1));
+		__m256i reached = _mm256_or_si256(_mm256_slli_epi64(current, 1), _mm256_srli_epi64(lower, 63));
+		reached = _mm256_or_si256(reached, _mm256_or_si256(_mm256_srli_epi64(current, 1), _mm256_slli_epi64(higher, 63)));
+		reached = _mm256_or_si256(reached, _mm256_loadu_si256((const __m256i*)(frontierAbove + w)));
+		reached = _mm256_or_si256(reached, _mm256_loadu_si256((const __m256i*)(frontierBelow + w)));
+		__m256i seen = _mm256_loadu_si256((const __m256i*)(visitedRow + w));
+		reached = _mm256_andnot_si256(seen, _mm256_and_si256(reached, _mm256_loadu_si256((const __m256i*)(openRow + w))));
+		_mm256_storeu_si256((__m256i*)(nextRow + w), reached);
+		_mm256_storeu_si256((__m256i*)(visitedRow + w), _mm256_or_si256(seen, reached));
+		any = _mm256_or_si256(any, reached);
+	}
+	return !_mm256_testz_si256(any, any);
+}
+#endif
+
+class LevelBarrier // Blocks until every thread taking part in a ParallelBFS level has arrived
+{
+private:
+	std::mutex lock;
+	std::condition_variable released;
+	int expected;
+	int waiting;
+	unsigned int generation;
+public:
+	LevelBarrier(int count)
+	{
+		this->expected = count;
+		this->waiting = 0;
+		this->generation = 0;
+	}
+	void arriveAndWait(void)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		unsigned int arrivedIn = generation;
+		if (++waiting == expected)
+		{
+			waiting = 0;
+			generation++;
+			released.notify_all();
+			return;
+		}
+		released.wait(guard, [&]() { return generation != arrivedIn; });
+	}
+};
+
+class PoolShutdown // Releases a ParallelBFS pool from its barrier and joins it, even when a stepped search is destroyed between levels
+{
+private:
+	bool& finished;
+	LevelBarrier& barrier;
+	std::vector<std::thread>& workers;
+	bool stopped;
+public:
+	PoolShutdown(bool& finished, LevelBarrier& barrier, std::vector<std::thread>& workers) : finished(finished), barrier(barrier), workers(workers)
+	{
+		this->stopped = false;
+	}
+	~PoolShutdown(void)
+	{
+		stop();
+	}
+	void stop(void)
+	{
+		if (stopped) return;
+		stopped = true;
+		finished = true;
+		if (!workers.empty()) barrier.arriveAndWait();
+		for (std::thread& worker : workers) worker.join();
+	}
+};
+
 MazeGenerator::MazeGenerator(Maze* maze)
 {
 	this->mazeSpaces = maze->getSpaces();
@@ -121,6 +246,37 @@ void RecursiveSubdivider::generateMaze(void)
 	return;
 }
 
+TerrainSubdivider::TerrainSubdivider(Maze* maze, int minSize, int patchCount) : RecursiveSubdivider(maze, minSize)
+{
+	this->patchCount = patchCount;
+}
+
+void TerrainSubdivider::generateMaze(void)
+{
+	RecursiveSubdivider::generateMaze();
+	int xSize = (int)mazeSpaces->size();
+	int ySize = (int)(*mazeSpaces)[0].size();
+	int patches = patchCount >= 0 ? patchCount : xSize * ySize / 64;
+	for (int patch = 0; patch < patches; patch++)
+	{
+		int centreX = random.nextBelow(xSize);
+		int centreY = random.nextBelow(ySize);
+		int radius = 1 + random.nextBelow(3);
+		int terrain = random.nextBelow(3);
+		for (int x = std::max(centreX - radius, 0); x <= std::min(centreX + radius, xSize - 1); x++)
+		{
+			for (int y = std::max(centreY - radius, 0); y <= std::min(centreY + radius, ySize - 1); y++)
+			{
+				if ((*mazeSpaces)[x][y]->GetColour() != "White") continue; // Only plain floor, leave the walls, the goal and earlier patches alone
+				delete (*mazeSpaces)[x][y];
+				if (terrain == 0) (*mazeSpaces)[x][y] = new Mud();
+				else if (terrain == 1) (*mazeSpaces)[x][y] = new Ramp();
+				else (*mazeSpaces)[x][y] = new SlowZone();
+			}
+		}
+	}
+}
+
 RecursiveSubdivider::~RecursiveSubdivider(void) // Make sure to delete all the chambers when you're done!
 {
 	for (Chamber* chamber : this->chambers)
@@ -150,8 +306,15 @@ Maze::Maze(int xSize, int ySize, int goalX, int goalY) // Maze must be at least
 	this->spaces[goalX][goalY] = new Goal();
 	this->xSize = xSize;
 	this->ySize = ySize;
+	this->startX = 0;
+	this->startY = 0;
 	this->goalX = goalX;
 	this->goalY = goalY;
+	this->goals.push_back(std::make_pair(goalX, goalY));
+	this->goalSpaces.assign(xSize * ySize, false);
+	this->goalSpaces[goalX * ySize + goalY] = true;
+	this->connectivity = FOUR_CONNECTED;
+	this->goalDistancesValid = false;
 	this->car = new Car(this);
 	
 }
@@ -188,6 +351,28 @@ Space Maze::GetSpace(int x, int y) // It's up to the caller to handle the except
 	return *this->spaces[x][y];
 }
 
+NeighbourList Maze::getOpenNeighbours(int x, int y)
+{
+	NeighbourList neighbours;
+	if (isPassable(x - 1, y)) neighbours.add((x - 1) * ySize + y);
+	if (isPassable(x, y - 1)) neighbours.add(x * ySize + y - 1);
+	if (isPassable(x + 1, y)) neighbours.add((x + 1) * ySize + y);
+	if (isPassable(x, y + 1)) neighbours.add(x * ySize + y + 1);
+	return neighbours;
+}
+
+int Maze::getCost(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	return this->spaces[x][y]->GetCost();
+}
+
+bool Maze::isPassable(int x, int y) // Out of bounds counts as a wall, so solvers can test neighbours without catching exceptions
+{
+	if (x < 0 || y < 0 || x >= this->xSize || y >= this->ySize) return false;
+	return this->spaces[x][y]->GetPassable();
+}
+
 void Maze::SetSpace(int x, int y, Space* newSpace) // It's up to the caller to handle the exception if they try to access a non-existent element here too
 {
 	if (x < 0 || y < 0 || x >= spaces.size() || y >= spaces[x].size())
@@ -196,6 +381,40 @@ void Maze::SetSpace(int x, int y, Space* newSpace) // It's up to the caller to h
 	}
 	delete(this->spaces[x][y]);
 	this->spaces[x][y] = newSpace;
+	this->goalDistancesValid = false;
+	for (MazeListener* listener : this->listeners)
+	{
+		listener->spaceChanged(x, y);
+	}
+}
+
+void Maze::addListener(MazeListener* listener)
+{
+	this->listeners.push_back(listener);
+}
+
+void Maze::removeListener(MazeListener* listener)
+{
+	this->listeners.erase(std::remove(this->listeners.begin(), this->listeners.end(), listener), this->listeners.end());
+}
+
+void Maze::setStart(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	if (!GetSpace(x, y).GetPassable()) SetSpace(x, y, new Empty()); // Same as a goal, the car can't start inside a wall
+	this->startX = x;
+	this->startY = y;
+	this->car->SetPos(x, y);
+}
+
+int Maze::getStartX(void)
+{
+	return this->startX;
+}
+
+int Maze::getStartY(void)
+{
+	return this->startY;
 }
 
 int Maze::getGoalX(void)
@@ -208,6 +427,80 @@ int Maze::getGoalY(void)
 	return this->goalY;
 }
 
+void Maze::addGoal(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	if (isGoal(x, y)) return;
+	this->goals.push_back(std::make_pair(x, y));
+	this->goalSpaces[x * ySize + y] = true;
+	SetSpace(x, y, new Goal()); // Last, so listeners like D* Lite already see it as a goal when they're told
+}
+
+bool Maze::isGoal(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) return false;
+	return this->goalSpaces[x * ySize + y];
+}
+
+int Maze::getGoalCount(void)
+{
+	return (int)this->goals.size();
+}
+
+std::vector<std::pair<int, int>> Maze::getGoals(void)
+{
+	return this->goals;
+}
+
+std::vector<int> Maze::getGoalIndices(void)
+{
+	std::vector<int> indices;
+	for (std::pair<int, int> goal : this->goals)
+	{
+		if (isPassable(goal.first, goal.second)) indices.push_back(goal.first * ySize + goal.second);
+	}
+	return indices;
+}
+
+int Maze::getGoalHeuristic(int x, int y)
+{
+	int nearest = INT_MAX;
+	for (std::pair<int, int> goal : this->goals) nearest = std::min(nearest, abs(x - goal.first) + abs(y - goal.second));
+	return nearest;
+}
+
+void Maze::buildGoalDistances(void) // One BFS outwards from every goal at once gives the distance to the nearest from every space
+{
+	goalDistances.assign(xSize * ySize, UNREACHABLE_DISTANCE);
+	goalDistancesValid = true;
+	std::vector<int> frontier = getGoalIndices();
+	for (int goalIndex : frontier) goalDistances[goalIndex] = 0;
+	for (size_t next = 0; next < frontier.size(); next++) // The vector doubles as the queue, since nothing is ever enqueued twice
+	{
+		int index = frontier[next];
+		for (int neighbourIndex : getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (goalDistances[neighbourIndex] != UNREACHABLE_DISTANCE) continue;
+			if (goalDistances[index] + 1 >= UNREACHABLE_DISTANCE) continue; // Only a maze of more than 65535 spaces gets this far, and the rest of it reads as unreachable
+			goalDistances[neighbourIndex] = goalDistances[index] + 1;
+			frontier.push_back(neighbourIndex);
+		}
+	}
+}
+
+std::vector<uint16_t>* Maze::getGoalDistances(void)
+{
+	if (!goalDistancesValid) buildGoalDistances();
+	return &this->goalDistances;
+}
+
+int Maze::getGoalDistance(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	uint16_t distance = (*getGoalDistances())[x * ySize + y];
+	return (distance == UNREACHABLE_DISTANCE) ? -1 : distance;
+}
+
 int Maze::getYSize(void)
 {
 	return this->ySize;
@@ -223,10 +516,21 @@ Car* Maze::GetCar(void)
 	return this->car;
 }
 
+void Maze::setConnectivity(Connectivity connectivity)
+{
+	this->connectivity = connectivity;
+}
+
+Connectivity Maze::getConnectivity(void)
+{
+	return this->connectivity;
+}
+
 void Maze::setGenerator(MazeGenerator* mazeGenerator)
 {
 	this->mazeGenerator = mazeGenerator;
 	mazeGenerator->generateMaze();
+	this->goalDistancesValid = false; // Generators write straight into the spaces rather than going through SetSpace
 }
 
 void Maze::setSolver(MazeSolver* mazeSolver)
@@ -237,6 +541,9 @@ void Maze::setSolver(MazeSolver* mazeSolver)
 Car::Car(Maze* maze)
 {
 	this->parentMaze = maze;
+	this->mazeSolver = NULL;
+	this->xPos = maze->getStartX();
+	this->yPos = maze->getStartY();
 }
 
 Car::~Car(void)
@@ -249,6 +556,11 @@ void Car::setMazeSolver(MazeSolver* mazeSolver)
 	this->mazeSolver = mazeSolver;
 }
 
+MazeSolver* Car::getMazeSolver(void)
+{
+	return this->mazeSolver;
+}
+
 void Car::SetPos(int x, int y)
 {
 	this->xPos = x;
@@ -275,6 +587,78 @@ Maze* Car::getParentMaze(void)
 	return this->parentMaze;
 }
 
+FastRandom::FastRandom(void)
+{
+	std::random_device randomiser;
+	setSeed(((uint64_t)randomiser() << 32) | randomiser());
+}
+
+FastRandom::FastRandom(uint64_t seed)
+{
+	setSeed(seed);
+}
+
+void FastRandom::setSeed(uint64_t seed)
+{
+	this->state = seed != 0 ? seed : 0x9E3779B97F4A7C15ULL; // xorshift gets stuck on an all-zero state
+}
+
+uint32_t FastRandom::next(void)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return (uint32_t)((state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+int FastRandom::nextBelow(int bound) // Slightly biased for large bounds, which doesn't matter for shuffling four neighbours
+{
+	return (int)(((uint64_t)next() * (uint64_t)bound) >> 32);
+}
+
+NeighbourList::NeighbourList(void)
+{
+	this->count = 0;
+}
+
+void NeighbourList::add(int index)
+{
+	this->cells[count++] = index;
+}
+
+int NeighbourList::size(void)
+{
+	return this->count;
+}
+
+int NeighbourList::operator[](int i)
+{
+	return this->cells[i];
+}
+
+const int* NeighbourList::begin(void)
+{
+	return this->cells;
+}
+
+const int* NeighbourList::end(void)
+{
+	return this->cells + count;
+}
+
+void NeighbourList::shuffle(FastRandom& random) // Fisher-Yates
+{
+	for (int i = count - 1; i > 0; i--)
+	{
+		std::swap(cells[i], cells[random.nextBelow(i + 1)]);
+	}
+}
+
+MazeListener::~MazeListener(void) // Nothing to free, this is just to satisfy the virtual declaration
+{
+
+}
+
 MazeSolver::MazeSolver(void)
 {
 
@@ -295,190 +679,245 @@ void MazeSolver::MoveToNext(void)
 	return;
 }
 
-FloodFill::FloodFill(Maze* maze)
+FloodFill::FloodFill(Maze* maze, bool exploring)
 {
 	this->setParentCar(maze->GetCar());
-	floodMap = generateFloodMap();
+	this->xSize = maze->getXSize();
+	this->ySize = maze->getYSize();
+	this->knownMap = exploring ? new PassabilityMap(xSize, ySize, true) : NULL;
+	this->sensor = exploring ? new WallSensor(maze) : NULL;
+	this->moveCount = 0;
+	this->moveTime = std::chrono::nanoseconds(0);
+	this->refloodQueue = std::vector<int>(xSize * ySize);
+	this->queued = std::vector<bool>(xSize * ySize, false);
+	this->refloodCount = 0;
+	this->refloodCellCount = 0;
+	this->floodUpdateCount = 0;
+	this->spaceOpened = false;
+	generateFloodMap();
+	maze->addListener(this);
 }
 
 FloodFill::~FloodFill(void)
 {
-	for (std::vector<Cell*> cellRow : this->floodMap)
-	{
-		for (Cell* cell : cellRow)
-		{
-			delete cell;
-		}
-	}
+	parentCar->getParentMaze()->removeListener(this);
+	delete this->knownMap;
+	delete this->sensor;
 }
 
-std::vector<std::vector<Cell*>> FloodFill::generateFloodMap(void) // Generate the initial floodmap, values are the Manhattan Distance from the goal
+void FloodFill::generateFloodMap(void) // Generate the initial floodmap, values are the Manhattan Distance from the nearest goal
 {
 	Maze* parentMaze = this->parentCar->getParentMaze();
-	std::vector<std::vector<Cell*>> returnVector;
-	for (int i = 0; i < parentMaze->getXSize(); i++)
+	floodValues = std::vector<uint16_t>(xSize * ySize);
+	for (int i = 0; i < xSize; i++)
 	{
-		returnVector.push_back(std::vector<Cell*>());
-		for (int j = 0; j < parentMaze->getYSize(); j++)
+		for (int j = 0; j < ySize; j++)
 		{
-			int value = abs(i - parentMaze->getGoalX()) + abs(j - parentMaze->getGoalY());
-			returnVector[i].push_back(new Cell(value, i, j));
+			int value = parentMaze->getGoalHeuristic(i, j);
+			floodValues[i * ySize + j] = (uint16_t)std::min(value, UNREACHABLE_FLOOD - 1);
 		}
 	}
-
-	return returnVector;
 }
 
 void FloodFill::MoveToNext(void)
 {
-	int localCellValue = floodMap[parentCar->GetX()][parentCar->GetY()]->GetFloodValue();
+	std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
 	int xPos = parentCar->GetX();
 	int yPos = parentCar->GetY();
-	Cell* lowestNeighbour = NULL;
-	bool canMove = true;
-	if (xPos == parentCar->getParentMaze()->getGoalX() && yPos == parentCar->getParentMaze()->getGoalY()) return; // Don't move if already at goal
-	for (Cell* neighbourCell : this->GetAdjacentCells(xPos, yPos)) // Search all neighbouring cells for one with a lower flood value
-	{
-		if (lowestNeighbour == NULL)
-		{
-			if (neighbourCell->GetFloodValue() < localCellValue) lowestNeighbour = neighbourCell;
-		}
-		else
-		{
-			if (neighbourCell->GetFloodValue() < lowestNeighbour->GetFloodValue()) lowestNeighbour = neighbourCell;
-		}
-	}
-	if (lowestNeighbour != NULL) this->parentCar->SetPos(lowestNeighbour->getX(), lowestNeighbour->getY());
-	else
+	if (parentCar->getParentMaze()->isGoal(xPos, yPos)) return; // Don't move if already at a goal
+	if (sensor != NULL) sensor->scan(xPos, yPos, knownMap); // Any new walls can only push values up, which the reflood below deals with
+	if (floodValues[xPos * ySize + yPos] == UNREACHABLE_FLOOD && getLowestNeighbourValue(xPos, yPos) != UNREACHABLE_FLOOD) spaceOpened = true; // The sensor found a way out
+	if (spaceOpened) reopenUnreachable();
+	if (getLowestNeighbourValue(xPos, yPos) >= floodValues[xPos * ySize + yPos]) reflood(xPos, yPos); // Stuck in a dip, so raise it until there's a way downhill
+	int localCellValue = floodValues[xPos * ySize + yPos];
+	int lowestNeighbour = -1;
+	if (localCellValue != UNREACHABLE_FLOOD)
 	{
-		std::stack<Cell*> cellStack;
-		Cell* topCell;
-		std::vector<Cell*> adjacentCells;
-		cellStack.push(floodMap[xPos][yPos]);
-		while (!cellStack.empty())
+		for (int neighbourIndex : this->GetAdjacentCells(xPos, yPos)) // Search all neighbouring cells for one with a lower flood value
 		{
-			lowestNeighbour = NULL;
-			topCell = cellStack.top();
-			cellStack.pop();
-			for (Cell* neighbourCell : this->GetAdjacentCells(topCell->getX(), topCell->getY())) // Get the lowest neighbour
-			{
-				if (lowestNeighbour == NULL)
-				{
-					lowestNeighbour = neighbourCell;
-				}
-				else
-				{
-					if (neighbourCell->GetFloodValue() < lowestNeighbour->GetFloodValue()) lowestNeighbour = neighbourCell;
-				}
-			}
-			std::cout << "Topcell value: " << topCell->GetFloodValue() << " Neighbour value: " << lowestNeighbour->GetFloodValue() << std::endl;
-			if (topCell->GetFloodValue() <= lowestNeighbour->GetFloodValue())
-			{
-				topCell->setValue(lowestNeighbour->GetFloodValue() + 1);
-				for (Cell* neighbourCell : this->GetAdjacentCells(topCell->getX(), topCell->getY()))
-				{
-					cellStack.push(neighbourCell);
-				}
-			}
-
+			if (floodValues[neighbourIndex] < localCellValue && (lowestNeighbour == -1 || floodValues[neighbourIndex] < floodValues[lowestNeighbour])) lowestNeighbour = neighbourIndex;
 		}
 	}
+	if (lowestNeighbour != -1) this->parentCar->SetPos(lowestNeighbour / ySize, lowestNeighbour % ySize);
+	moveCount++;
+	moveTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - startTime);
+}
 
-
+void FloodFill::spaceChanged(int x, int y) // Refloods only ever raise values, so a space that opens up can't lower UNREACHABLE_FLOOD on its own
+{
+	if (parentCar->getParentMaze()->isPassable(x, y)) spaceOpened = true;
 }
 
-std::vector<Cell*> FloodFill::GetAdjacentCells(int x, int y)
+void FloodFill::reopenUnreachable(void) // Back down to the Manhattan distance, the next refloods raise them again only as far as they need
 {
-	std::vector<Cell*> adjacentCells;
-	if (x > 0)
-	{
-		if (this->parentCar->getParentMaze()->GetSpace(x-1,  y).GetPassable())
-		{
-			adjacentCells.push_back(floodMap[x - 1][y]);
-		}
-	}
-	if (y > 0)
+	Maze* parentMaze = this->parentCar->getParentMaze();
+	for (int index = 0; index < xSize * ySize; index++)
 	{
-		if (this->parentCar->getParentMaze()->GetSpace(x, y - 1).GetPassable())
-		{
-			adjacentCells.push_back(floodMap[x][y - 1]);
-		}
+		if (floodValues[index] == UNREACHABLE_FLOOD) floodValues[index] = (uint16_t)std::min(parentMaze->getGoalHeuristic(index / ySize, index % ySize), UNREACHABLE_FLOOD - 1);
 	}
-	if (x < (parentCar->getParentMaze()->getXSize() - 1))
+	spaceOpened = false;
+}
+
+bool FloodFill::isOpen(int x, int y)
+{
+	if (knownMap != NULL) return knownMap->get(x, y);
+	return parentCar->getParentMaze()->isPassable(x, y);
+}
+
+void FloodFill::reflood(int x, int y)
+{
+	Maze* parentMaze = this->parentCar->getParentMaze();
+	int head = 0;
+	int size = 1;
+	refloodQueue[0] = x * ySize + y;
+	queued[x * ySize + y] = true;
+	refloodCount++;
+	auto isGoal = [this, parentMaze](int index) { return parentMaze->isGoal(index / ySize, index % ySize); };
+	auto isOpenSpace = [this](int cellX, int cellY) { return isOpen(cellX, cellY); };
+	// A reflood that pops more spaces than the maze has is most likely a walled-off component creeping up towards UNREACHABLE_FLOOD,
+	// so check that with one search instead of letting it climb.
+	refloodCellCount += runReflood(floodValues, refloodQueue, head, size, queued, xSize, ySize, isGoal, xSize * ySize, isOpenSpace, floodUpdateCount);
+	if (size > 0 && settleIfWalledOff(x, y))
 	{
-		if (this->parentCar->getParentMaze()->GetSpace(x + 1, y).GetPassable())
-		{
-			adjacentCells.push_back(floodMap[x + 1][y]);
-		}
+		for (; size > 0; size--, head = (head + 1) % (xSize * ySize)) queued[refloodQueue[head]] = false;
+		return;
 	}
-	if (y < (parentCar->getParentMaze()->getYSize() - 1))
+	refloodCellCount += runReflood(floodValues, refloodQueue, head, size, queued, xSize, ySize, isGoal, INT_MAX, isOpenSpace, floodUpdateCount);
+}
+
+bool FloodFill::settleIfWalledOff(int x, int y)
+{
+	Maze* parentMaze = this->parentCar->getParentMaze();
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	std::vector<bool> seen(xSize * ySize, false);
+	std::vector<int> component(1, x * ySize + y);
+	seen[x * ySize + y] = true;
+	for (size_t next = 0; next < component.size(); next++)
 	{
+		int cellX = component[next] / ySize;
+		int cellY = component[next] % ySize;
+		if (parentMaze->isGoal(cellX, cellY)) return false;
+		for (int direction = 0; direction < 4; direction++)
 		{
-			if (this->parentCar->getParentMaze()->GetSpace(x, y + 1).GetPassable())
-			{
-				adjacentCells.push_back(floodMap[x][y + 1]);
-			}
+			int neighbourX = cellX + xOffsets[direction];
+			int neighbourY = cellY + yOffsets[direction];
+			if (!isOpen(neighbourX, neighbourY) || seen[neighbourX * ySize + neighbourY]) continue;
+			seen[neighbourX * ySize + neighbourY] = true;
+			component.push_back(neighbourX * ySize + neighbourY);
 		}
 	}
-	std::random_device randomiser;
-	std::shuffle(adjacentCells.begin(), adjacentCells.end(), randomiser);
+	for (int index : component) floodValues[index] = UNREACHABLE_FLOOD;
+	return true;
+}
+
+uint16_t FloodFill::getLowestNeighbourValue(int x, int y) // UNREACHABLE_FLOOD if there are no open neighbours
+{
+	uint16_t lowest = UNREACHABLE_FLOOD;
+	if (isOpen(x - 1, y)) lowest = std::min(lowest, floodValues[(x - 1) * ySize + y]);
+	if (isOpen(x + 1, y)) lowest = std::min(lowest, floodValues[(x + 1) * ySize + y]);
+	if (isOpen(x, y - 1)) lowest = std::min(lowest, floodValues[x * ySize + y - 1]);
+	if (isOpen(x, y + 1)) lowest = std::min(lowest, floodValues[x * ySize + y + 1]);
+	return lowest;
+}
+
+NeighbourList FloodFill::GetAdjacentCells(int x, int y)
+{
+	NeighbourList adjacentCells = (knownMap != NULL) ? knownMap->getOpenNeighbours(x, y) : this->parentCar->getParentMaze()->getOpenNeighbours(x, y);
+	adjacentCells.shuffle(this->random);
 	return adjacentCells;
 }
 
-Cell::Cell(int value, int x, int y)
+void FloodFill::setSeed(uint64_t seed)
 {
-	this->floodValue = value;
-	this->x = x;
-	this->y = y;
+	this->random.setSeed(seed);
 }
-int Cell::GetFloodValue(void)
+
+int FloodFill::GetFloodValue(int x, int y)
 {
-	return this->floodValue;
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	return this->floodValues[x * ySize + y];
 }
 
-void Cell::decValue(int amount)
+PassabilityMap* FloodFill::getKnownMap(void)
 {
-	this->floodValue += amount;
+	return this->knownMap;
 }
 
-void Cell::incValue(int amount)
+WallSensor* FloodFill::getSensor(void)
 {
-	this->floodValue += amount;
+	return this->sensor;
 }
 
-void Cell::setValue(int amount)
+long long FloodFill::getMoveCount(void)
 {
-	this->floodValue = amount;
+	return this->moveCount;
 }
 
-int Cell::getX(void)
+double FloodFill::getAverageMoveTime(void)
 {
-	return this->x;
+	if (moveCount == 0) return 0.0;
+	return std::chrono::duration<double>(moveTime).count() / moveCount;
 }
 
-int Cell::getY(void)
+long long FloodFill::getRefloodCount(void)
 {
-	return this->y;
+	return this->refloodCount;
 }
 
-Dijkstra::Dijkstra(Maze* maze)
+long long FloodFill::getRefloodCellCount(void)
 {
-	this->parentCar = maze->GetCar();
+	return this->refloodCellCount;
+}
+
+long long FloodFill::getFloodUpdateCount(void)
+{
+	return this->floodUpdateCount;
+}
+
+static Node* getNodeOrNull(std::vector<std::vector<Node*>>& nodes, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= (int)nodes.size() || y >= (int)nodes[x].size()) return NULL;
+	return nodes[x][y];
+}
+
+static void addDiagonalNeighbours(std::vector<std::vector<Node*>>& nodes, int x, int y) // Only where both spaces beside the diagonal are open, so the car can't cut a wall's corner
+{
+	for (int xOffset = -1; xOffset <= 1; xOffset += 2)
+	{
+		for (int yOffset = -1; yOffset <= 1; yOffset += 2)
+		{
+			Node* diagonal = getNodeOrNull(nodes, x + xOffset, y + yOffset);
+			if (diagonal == NULL || getNodeOrNull(nodes, x + xOffset, y) == NULL || getNodeOrNull(nodes, x, y + yOffset) == NULL) continue;
+			nodes[x][y]->getNeighbours()->push_back(diagonal);
+		}
+	}
+}
+
+static int getStepCost(Node* from, Node* to, bool eightConnected) // The tile cost, scaled by Maze::STRAIGHT_MOVE_COST or DIAGONAL_MOVE_COST when diagonals are allowed
+{
+	if (!eightConnected) return to->getCost();
+	bool diagonal = from->getX() != to->getX() && from->getY() != to->getY();
+	return to->getCost() * (diagonal ? Maze::DIAGONAL_MOVE_COST : Maze::STRAIGHT_MOVE_COST);
+}
+
+Dijkstra::Dijkstra(Maze* maze, PassabilityMap* mask, int expansionsPerSlice) : SteppedSolver(maze, expansionsPerSlice)
+{
+	this->eightConnected = maze->getConnectivity() == EIGHT_CONNECTED;
 	for (int i = 0; i < maze->getXSize(); i++) // Populate the node set with nodes that correspond to spaces in the maze. 
 	{
 		this->nodes.push_back(std::vector<Node*>());
 		for (int j = 0; j < maze->getYSize(); j++)
 		{
-			if (maze->GetSpace(i, j).GetPassable())
+			if (mask != NULL ? mask->get(i, j) : maze->GetSpace(i, j).GetPassable())
 			{
-				Node* newNode = new Node(i, j);
+				Node* newNode = new Node(i, j, 0, maze->getCost(i, j));
 				nodes[i].push_back(newNode);
 				unvisitedNodes.push_back(newNode);
 			}
 			else nodes[i].push_back(NULL);
 		}
 	}
-	this->goalNode = nodes[maze->getGoalX()][maze->getGoalY()];
 	for (int i = 0; i < nodes.size(); i++) // Now iterate through every node in the vector and connect them to their neighbours
 	{
 		for (int j = 0; j < nodes[i].size(); j++)
@@ -511,10 +950,13 @@ Dijkstra::Dijkstra(Maze* maze)
 						continue;
 					}
 				}
+				if (eightConnected) addDiagonalNeighbours(nodes, i, j);
 			}
 		}
 	}
-	findShortestPath();
+	this->searchX = maze->getStartX();
+	this->searchY = maze->getStartY();
+	if (expansionsPerSlice == 0) finish();
 }
 
 Node* Dijkstra::getClosestedUnvisitedNode(void)
@@ -532,70 +974,112 @@ Node* Dijkstra::getClosestedUnvisitedNode(void)
 	return closestNode;
 }
 
-void Dijkstra::findShortestPath(void)
+SearchTask Dijkstra::search(void)
 {
-	nodes[0][0]->setDistance(0); // The starting node, which is assumed to be (0,0) is always initialised to a distance of 0
-	currentNode = nodes[0][0];
-	int initialSize = unvisitedNodes.size();
-	while (currentNode != goalNode && currentNode->getDistance() != INT_MAX)
+	if (nodes[searchX][searchY] == NULL) co_return; // Starting inside a wall, there's nowhere to go
+	int ySize = parentMaze->getYSize();
+	nodes[searchX][searchY]->setDistance(0); // The starting node is always initialised to a distance of 0
+	Node* currentNode = nodes[searchX][searchY];
+	int sliceExpansions = 0;
+	while (currentNode != NULL && !parentMaze->isGoal(currentNode->getX(), currentNode->getY()) && currentNode->getDistance() != INT_MAX) // The first goal settled is the nearest
 	{
 		for (Node* neighbourNode : *currentNode->getNeighbours())
 		{
-			if (neighbourNode->getDistance() == INT_MAX || neighbourNode->getDistance() > currentNode->getDistance() + 1)
+			int stepCost = getStepCost(currentNode, neighbourNode, eightConnected);
+			if (neighbourNode->getDistance() == INT_MAX || neighbourNode->getDistance() > currentNode->getDistance() + stepCost)
 			{
 				neighbourNode->setPrevious(currentNode);
-				neighbourNode->setDistance(currentNode->getDistance() + 1);
+				neighbourNode->setDistance(currentNode->getDistance() + stepCost);
+				marks[neighbourNode->getX() * ySize + neighbourNode->getY()] = FRONTIER;
 			}
 		}
 		unvisitedNodes.erase(std::find(unvisitedNodes.begin(), unvisitedNodes.end(), currentNode));
+		marks[currentNode->getX() * ySize + currentNode->getY()] = VISITED;
+		examinedNodes++;
+		if (++sliceExpansions == expansionsPerSlice)
+		{
+			sliceExpansions = 0;
+			co_yield examinedNodes;
+		}
 		currentNode = getClosestedUnvisitedNode();
 	}
-	std::cout << "Found solution after examining " << initialSize - unvisitedNodes.size() << " nodes"  << std::endl;
-
-	while (currentNode->getPrevious() != NULL)
-	{
-		route.push(currentNode);
-		currentNode = currentNode->getPrevious();
-	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes"  << std::endl;
+	if (currentNode == NULL || !parentMaze->isGoal(currentNode->getX(), currentNode->getY())) co_return;
+	std::vector<int> path;
+	for (Node* node = currentNode; node != NULL; node = node->getPrevious()) path.push_back(node->getX() * ySize + node->getY());
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
 }
 
-void Dijkstra::MoveToNext(void)
+void Dijkstra::solveFrom(int x, int y)
 {
-	if (route.empty()) return;
-	int nextX = route.top()->getX();
-	int nextY = route.top()->getY();
-	this->parentCar->SetPos(nextX, nextY);
-	route.pop();
+	if (x < 0 || y < 0 || x >= (int)nodes.size() || y >= (int)nodes[x].size()) throw std::out_of_range("Index out of range");
+	restart();
+	unvisitedNodes.clear();
+	for (std::vector<Node*>& column : nodes)
+	{
+		for (Node* node : column)
+		{
+			if (node == NULL) continue;
+			node->setDistance(INT_MAX);
+			node->setPrevious(NULL);
+			unvisitedNodes.push_back(node);
+		}
+	}
+	this->searchX = x;
+	this->searchY = y;
+	if (expansionsPerSlice == 0) finish();
 }
 
-void AStar::MoveToNext(void)
+void AStar::solveFrom(int x, int y)
 {
-	if (route.empty()) return;
-	int nextX = route.top()->getX();
-	int nextY = route.top()->getY();
-	this->parentCar->SetPos(nextX, nextY);
-	route.pop();
+	if (x < 0 || y < 0 || x >= (int)nodes.size() || y >= (int)nodes[x].size()) throw std::out_of_range("Index out of range");
+	restart();
+	unvisitedNodes.clear();
+	for (std::vector<Node*>& column : nodes)
+	{
+		for (Node* node : column)
+		{
+			if (node == NULL) continue;
+			node->setDistance(INT_MAX);
+			node->setPrevious(NULL);
+			unvisitedNodes.push_back(node);
+		}
+	}
+	this->searchX = x;
+	this->searchY = y;
+	if (expansionsPerSlice == 0) finish();
 }
 
-AStar::AStar(Maze* maze)
+AStar::AStar(Maze* maze, PassabilityMap* mask, int expansionsPerSlice) : SteppedSolver(maze, expansionsPerSlice)
 {
-	this->parentCar = maze->GetCar();
+	this->eightConnected = maze->getConnectivity() == EIGHT_CONNECTED;
+	std::vector<std::pair<int, int>> goals = maze->getGoals();
 	for (int i = 0; i < maze->getXSize(); i++) // Populate the node set with nodes that correspond to spaces in the maze. 
 	{
 		this->nodes.push_back(std::vector<Node*>());
 		for (int j = 0; j < maze->getYSize(); j++)
 		{
-			if (maze->GetSpace(i, j).GetPassable())
+			if (mask != NULL ? mask->get(i, j) : maze->GetSpace(i, j).GetPassable())
 			{
-				int nodeWeight = abs(i + maze->getGoalX()) + abs(j + maze->getGoalY());
-				Node* newNode = new Node(i, j, nodeWeight);
+				int nodeWeight = maze->getGoalHeuristic(i, j); // Manhattan distance to the nearest goal, which never overestimates since every move costs at least 1
+				if (eightConnected) // Octile distance: diagonals for the shorter axis, straight moves for the rest
+				{
+					nodeWeight = INT_MAX;
+					for (std::pair<int, int> goal : goals)
+					{
+						int xDistance = abs(i - goal.first);
+						int yDistance = abs(j - goal.second);
+						nodeWeight = std::min(nodeWeight, Maze::STRAIGHT_MOVE_COST * std::max(xDistance, yDistance) + (Maze::DIAGONAL_MOVE_COST - Maze::STRAIGHT_MOVE_COST) * std::min(xDistance, yDistance));
+					}
+				}
+				Node* newNode = new Node(i, j, nodeWeight, maze->getCost(i, j));
 				nodes[i].push_back(newNode);
 				unvisitedNodes.push_back(newNode);
 			}
 			else nodes[i].push_back(NULL);
 		}
 	}
-	this->goalNode = nodes[maze->getGoalX()][maze->getGoalY()];
 	for (int i = 0; i < nodes.size(); i++) // Now iterate through every node in the vector and connect them to their neighbours
 	{
 		for (int j = 0; j < nodes[i].size(); j++)
@@ -628,36 +1112,50 @@ AStar::AStar(Maze* maze)
 						continue;
 					}
 				}
+				if (eightConnected) addDiagonalNeighbours(nodes, i, j);
 			}
 		}
 	}
-	findShortestPath();
+	this->searchX = maze->getStartX();
+	this->searchY = maze->getStartY();
+	if (expansionsPerSlice == 0) finish();
 }
 
-void AStar::findShortestPath(void)
+SearchTask AStar::search(void)
 {
-	nodes[0][0]->setDistance(0); // The starting node, which is assumed to be (0,0) is always initialised to a distance of 0
-	currentNode = nodes[0][0];
-	int initialSize = unvisitedNodes.size();
-	while (currentNode != goalNode && currentNode->getDistance() != INT_MAX)
+	if (nodes[searchX][searchY] == NULL) co_return; // Starting inside a wall, there's nowhere to go
+	int ySize = parentMaze->getYSize();
+	nodes[searchX][searchY]->setDistance(0); // The starting node is always initialised to a distance of 0
+	Node* currentNode = nodes[searchX][searchY];
+	int sliceExpansions = 0;
+	while (currentNode != NULL && !parentMaze->isGoal(currentNode->getX(), currentNode->getY()) && currentNode->getDistance() != INT_MAX) // The first goal settled is the nearest
 	{
 		for (Node* neighbourNode : *currentNode->getNeighbours())
 		{
-			if (neighbourNode->getDistance() == INT_MAX || neighbourNode->getDistance() + neighbourNode->getWeight() > currentNode->getDistance() + neighbourNode->getWeight() + 1)
+			int stepCost = getStepCost(currentNode, neighbourNode, eightConnected);
+			if (neighbourNode->getDistance() == INT_MAX || neighbourNode->getDistance() > currentNode->getDistance() + stepCost) // Distance is the cost so far, the weight only orders the search
 			{
 				neighbourNode->setPrevious(currentNode);
-				neighbourNode->setDistance(currentNode->getDistance() + neighbourNode->getWeight() + 1);
+				neighbourNode->setDistance(currentNode->getDistance() + stepCost);
+				marks[neighbourNode->getX() * ySize + neighbourNode->getY()] = FRONTIER;
 			}
 		}
 		unvisitedNodes.erase(std::find(unvisitedNodes.begin(), unvisitedNodes.end(), currentNode));
+		marks[currentNode->getX() * ySize + currentNode->getY()] = VISITED;
+		examinedNodes++;
+		if (++sliceExpansions == expansionsPerSlice)
+		{
+			sliceExpansions = 0;
+			co_yield examinedNodes;
+		}
 		currentNode = getClosestedUnvisitedNode();
 	}
-	std::cout << "Found solution after examining " << initialSize - unvisitedNodes.size() << " nodes" << std::endl;
-	while (currentNode->getPrevious() != NULL)
-	{
-		route.push(currentNode);
-		currentNode = currentNode->getPrevious();
-	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (currentNode == NULL || !parentMaze->isGoal(currentNode->getX(), currentNode->getY())) co_return;
+	std::vector<int> path;
+	for (Node* node = currentNode; node != NULL; node = node->getPrevious()) path.push_back(node->getX() * ySize + node->getY());
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
 }
 
 Node* AStar::getClosestedUnvisitedNode()
@@ -673,17 +1171,2687 @@ Node* AStar::getClosestedUnvisitedNode()
 		}
 	}
 
-	if (closestNode == NULL) throw(std::runtime_error("No connected unvisited nodes available!"));
-	return closestNode;
+	return closestNode; // NULL once nothing reachable is left, which findShortestPath treats as no route
 }
 
-Node::Node(int X, int Y, int weight)
+PathSolver::PathSolver(Maze* maze)
 {
-	this->x = X;
-	this->y = Y;
-	this->distance = INT_MAX;
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->examinedNodes = 0;
+}
+
+void PathSolver::setRoute(std::vector<int>& path) // The first entry is where the car already is, so it isn't pushed
+{
+	int ySize = this->parentMaze->getYSize();
+	while (!route.empty()) route.pop();
+	for (int i = (int)path.size() - 1; i > 0; i--)
+	{
+		route.push(std::make_pair(path[i] / ySize, path[i] % ySize));
+	}
+}
+
+void PathSolver::MoveToNext(void)
+{
+	if (route.empty()) return;
+	this->parentCar->SetPos(route.top().first, route.top().second);
+	route.pop();
+}
+
+int PathSolver::getRouteLength(void)
+{
+	return (int)this->route.size();
+}
+
+int PathSolver::getExaminedNodes(void)
+{
+	return this->examinedNodes;
+}
+
+BidirectionalBFS::BidirectionalBFS(Maze* maze, int expansionsPerSlice) : SteppedSolver(maze, expansionsPerSlice)
+{
+	if (expansionsPerSlice == 0) finish();
+}
+
+SearchTask BidirectionalBFS::search(void)
+{
+	int xSize = parentMaze->getXSize();
+	int ySize = parentMaze->getYSize();
+	int startX = parentMaze->getStartX();
+	int startY = parentMaze->getStartY();
+	int startIndex = startX * ySize + startY;
+	std::vector<int> goalIndices = parentMaze->getGoalIndices();
+	if (!parentMaze->isPassable(startX, startY) || goalIndices.empty()) co_return;
+
+	// Index 0 holds the forward search from the start, index 1 the backward search from every goal at once
+	std::vector<int> distance[2] = { std::vector<int>(xSize * ySize, -1), std::vector<int>(xSize * ySize, -1) };
+	std::vector<int> previous[2] = { std::vector<int>(xSize * ySize, -1), std::vector<int>(xSize * ySize, -1) };
+	std::vector<int> frontier[2] = { std::vector<int>(1, startIndex), goalIndices };
+	std::vector<int> nextFrontier;
+	distance[0][startIndex] = 0;
+	marks[startIndex] = FRONTIER;
+	for (int goalIndex : goalIndices)
+	{
+		distance[1][goalIndex] = 0;
+		marks[goalIndex] = FRONTIER;
+	}
+	bool startIsGoal = parentMaze->isGoal(startX, startY);
+	examinedNodes = startIsGoal ? 1 : 1 + (int)goalIndices.size();
+	int bestLength = startIsGoal ? 0 : INT_MAX;
+	int meetingIndex = startIndex;
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int sliceExpansions = 0;
+
+	// Always expand the smaller frontier by one whole level. The first level that produces a meeting contains the shortest path,
+	// so the search finishes that level (to pick the best meeting point) and then stops.
+	while (bestLength == INT_MAX && !frontier[0].empty() && !frontier[1].empty())
+	{
+		int side = (frontier[0].size() <= frontier[1].size()) ? 0 : 1;
+		nextFrontier.clear();
+		for (int index : frontier[side])
+		{
+			int x = index / ySize;
+			int y = index % ySize;
+			marks[index] = VISITED;
+			for (int direction = 0; direction < 4; direction++)
+			{
+				int neighbourX = x + xOffsets[direction];
+				int neighbourY = y + yOffsets[direction];
+				if (!parentMaze->isPassable(neighbourX, neighbourY)) continue;
+				int neighbourIndex = neighbourX * ySize + neighbourY;
+				if (distance[side][neighbourIndex] != -1) continue;
+				distance[side][neighbourIndex] = distance[side][index] + 1;
+				previous[side][neighbourIndex] = index;
+				nextFrontier.push_back(neighbourIndex);
+				if (marks[neighbourIndex] == UNSEEN) marks[neighbourIndex] = FRONTIER;
+				examinedNodes++;
+				if (distance[1 - side][neighbourIndex] != -1 && distance[0][neighbourIndex] + distance[1][neighbourIndex] < bestLength)
+				{
+					bestLength = distance[0][neighbourIndex] + distance[1][neighbourIndex];
+					meetingIndex = neighbourIndex;
+				}
+			}
+			if (++sliceExpansions == expansionsPerSlice) // Safe mid-level, the level being built is kept apart in nextFrontier
+			{
+				sliceExpansions = 0;
+				co_yield examinedNodes;
+			}
+		}
+		frontier[side].swap(nextFrontier);
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (bestLength == INT_MAX) co_return; // The goal isn't reachable
+
+	std::vector<int> path;
+	for (int index = meetingIndex; index != -1; index = previous[0][index]) path.push_back(index);
+	std::reverse(path.begin(), path.end());
+	for (int index = previous[1][meetingIndex]; index != -1; index = previous[1][index]) path.push_back(index);
+	setRoute(path);
+}
+
+PassabilityMap::PassabilityMap(Maze* maze)
+{
+	this->xSize = maze->getXSize();
+	this->ySize = maze->getYSize();
+	this->wordsPerRow = (xSize + 63) / 64;
+	this->bits = std::vector<uint64_t>(wordsPerRow * ySize, 0); // Padding bits past the end of a row stay 0, so they act as walls
+	for (int i = 0; i < xSize; i++)
+	{
+		for (int j = 0; j < ySize; j++)
+		{
+			if (maze->isPassable(i, j)) set(i, j, true);
+		}
+	}
+}
+
+PassabilityMap::PassabilityMap(int xSize, int ySize, bool passable)
+{
+	this->xSize = xSize;
+	this->ySize = ySize;
+	this->wordsPerRow = (xSize + 63) / 64;
+	this->bits = std::vector<uint64_t>(wordsPerRow * ySize, 0);
+	if (!passable) return;
+	for (int j = 0; j < ySize; j++)
+	{
+		for (int i = 0; i < xSize; i++)
+		{
+			set(i, j, true);
+		}
+	}
+}
+
+bool PassabilityMap::get(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) return false;
+	return (bits[y * wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+void PassabilityMap::set(int x, int y, bool passable)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	if (passable) bits[y * wordsPerRow + x / 64] |= (uint64_t)1 << (x % 64);
+	else bits[y * wordsPerRow + x / 64] &= ~((uint64_t)1 << (x % 64));
+}
+
+uint64_t PassabilityMap::getWord(int word, int y)
+{
+	if (word < 0 || y < 0 || word >= wordsPerRow || y >= ySize) return 0;
+	return bits[y * wordsPerRow + word];
+}
+
+int PassabilityMap::getXSize(void)
+{
+	return this->xSize;
+}
+
+int PassabilityMap::getYSize(void)
+{
+	return this->ySize;
+}
+
+int PassabilityMap::getWordsPerRow(void)
+{
+	return this->wordsPerRow;
+}
+
+NeighbourList PassabilityMap::getOpenNeighbours(int x, int y)
+{
+	NeighbourList neighbours;
+	if (get(x - 1, y)) neighbours.add((x - 1) * ySize + y);
+	if (get(x, y - 1)) neighbours.add(x * ySize + y - 1);
+	if (get(x + 1, y)) neighbours.add((x + 1) * ySize + y);
+	if (get(x, y + 1)) neighbours.add(x * ySize + y + 1);
+	return neighbours;
+}
+
+BitParallelBFS::BitParallelBFS(Maze* maze, bool allowSimd, int expansionsPerSlice) : SteppedSolver(maze, expansionsPerSlice)
+{
+	PassabilityMap map(maze);
+	this->xSize = maze->getXSize();
+	this->ySize = maze->getYSize();
+	this->wordsPerRow = map.getWordsPerRow();
+	this->stride = (wordsPerRow + 3) / 4 * 4 + 2;
+	this->useSimd = allowSimd && cpuSupportsAvx2();
+	this->levelCount = 0;
+	open.assign((ySize + 2) * stride, 0);
+	for (int y = 0; y < ySize; y++)
+	{
+		for (int w = 0; w < wordsPerRow; w++) open[(y + 1) * stride + 1 + w] = map.getWord(w, y);
+	}
+	if (expansionsPerSlice == 0) finish();
+}
+
+bool BitParallelBFS::cpuSupportsAvx2(void)
+{
+#if defined(_MSC_VER) && defined(HAS_AVX2_PATH)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	if (!(info[2] & (1 << 27))) return false; // No OSXSAVE, so the OS may not save the YMM registers
+	if ((_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(HAS_AVX2_PATH)
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+void BitParallelBFS::expandRows(int firstRow, int lastRow)
+{
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		int base = row * stride + 1;
+#ifdef HAS_AVX2_PATH
+		if (useSimd)
+		{
+			expandRowAvx2(&frontier[base], &frontier[base - stride], &frontier[base + stride], &open[base], &visited[base], &next[base], wordsPerRow);
+			continue;
+		}
+#endif
+		for (int w = base; w < base + wordsPerRow; w++)
+		{
+			uint64_t current = frontier[w];
+			uint64_t reached = (current << 1) | (frontier[w - 1] >> 63) | (current >> 1) | (frontier[w + 1] << 63) | frontier[w - stride] | frontier[w + stride];
+			reached &= open[w] & ~visited[w];
+			next[w] = reached;
+			visited[w] |= reached;
+		}
+	}
+}
+
+void BitParallelBFS::computeLevels(int startX, int startY, bool stopAtGoal)
+{
+	SearchTask levelSearch = searchLevels(startX, startY, stopAtGoal);
+	while (levelSearch.resume());
+}
+
+SearchTask BitParallelBFS::searchLevels(int startX, int startY, bool stopAtGoal)
+{
+	levels.assign(xSize * ySize, -1);
+	visited.assign(open.size(), 0);
+	frontier.assign(open.size(), 0);
+	next.assign(open.size(), 0);
+	levelCount = 0;
+	examinedNodes = 0;
+	if (startX < 0 || startY < 0 || startX >= xSize || startY >= ySize || !parentMaze->isPassable(startX, startY)) co_return;
+	int startWord = (startY + 1) * stride + 1 + startX / 64;
+	frontier[startWord] = visited[startWord] = (uint64_t)1 << (startX % 64);
+	levels[startX * ySize + startY] = 0;
+	examinedNodes = 1;
+	int firstRow = startY + 1, lastRow = startY + 1; // Padded rows the frontier occupies
+	bool stopReached = stopAtGoal && parentMaze->isGoal(startX, startY);
+	std::vector<int> lastLevel(1, startX * ySize + startY);
+	bool keepMarks = expansionsPerSlice != 0; // Marking costs as much as the search itself, and is only worth it if the search can be seen part way
+	if (keepMarks) marks[startX * ySize + startY] = FRONTIER;
+	int sliceExpansions = 0;
+	while (!stopReached)
+	{
+		int levelStart = examinedNodes;
+		stopReached = expandLevel(firstRow, lastRow, stopAtGoal, keepMarks ? &lastLevel : NULL);
+		if (lastRow == -1) break;
+		sliceExpansions += examinedNodes - levelStart; // A level is one pass over the rows, so it can't be split
+		if (expansionsPerSlice != 0 && sliceExpansions >= expansionsPerSlice && !stopReached)
+		{
+			sliceExpansions = 0;
+			co_yield examinedNodes;
+		}
+	}
+}
+
+bool BitParallelBFS::expandLevel(int& firstRow, int& lastRow, bool stopAtGoal, std::vector<int>* lastLevel)
+{
+	bool stopReached = false;
+	if (lastLevel != NULL)
+	{
+		for (int index : *lastLevel) marks[index] = VISITED;
+		lastLevel->clear();
+	}
+	int from = std::max(firstRow - 1, 1), to = std::min(lastRow + 1, ySize);
+	expandRows(from, to);
+	for (int row = firstRow; row <= lastRow; row++) std::fill(frontier.begin() + row * stride, frontier.begin() + (row + 1) * stride, 0); // Clear the old frontier so the buffers can swap
+	std::swap(frontier, next);
+	levelCount++;
+	firstRow = INT_MAX;
+	lastRow = -1;
+	for (int row = from; row <= to; row++) // Only the newly reached spaces need their level written, a bit at a time
+	{
+		for (int w = 0; w < wordsPerRow; w++)
+		{
+			uint64_t word = frontier[row * stride + 1 + w];
+			if (word == 0) continue;
+			firstRow = std::min(firstRow, row);
+			lastRow = row;
+			while (word != 0)
+			{
+				int x = w * 64 + lowestSetBit(word);
+				word &= word - 1;
+				levels[x * ySize + row - 1] = levelCount;
+				examinedNodes++;
+				if (lastLevel != NULL)
+				{
+					marks[x * ySize + row - 1] = FRONTIER;
+					lastLevel->push_back(x * ySize + row - 1);
+				}
+				if (stopAtGoal && parentMaze->isGoal(x, row - 1)) stopReached = true;
+			}
+		}
+	}
+	return stopReached;
+}
+
+SearchTask BitParallelBFS::search(void)
+{
+	SearchTask levelSearch = searchLevels(parentMaze->getStartX(), parentMaze->getStartY(), true);
+	while (levelSearch.resume()) co_yield examinedNodes;
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	int goalIndex = -1;
+	for (int index : parentMaze->getGoalIndices())
+	{
+		if (levels[index] != -1 && (goalIndex == -1 || levels[index] < levels[goalIndex])) goalIndex = index;
+	}
+	if (goalIndex == -1) co_return;
+	std::vector<int> path(1, goalIndex);
+	while (levels[path.back()] > 0) // Walk back down the levels
+	{
+		int index = path.back();
+		for (int neighbour : parentMaze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (levels[neighbour] == levels[index] - 1)
+			{
+				path.push_back(neighbour);
+				break;
+			}
+		}
+	}
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+int BitParallelBFS::getLevel(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= xSize || y >= ySize) throw std::out_of_range("Index out of range");
+	return levels[x * ySize + y];
+}
+
+int BitParallelBFS::getLevelCount(void)
+{
+	return this->levelCount;
+}
+
+bool BitParallelBFS::isUsingSimd(void)
+{
+	return this->useSimd;
+}
+
+ParallelBFS::ParallelBFS(Maze* maze, int threadCount, int expansionsPerSlice) : SteppedSolver(maze, expansionsPerSlice)
+{
+	if (threadCount < 0) throw std::invalid_argument("Thread count can't be negative!");
+	this->threadCount = threadCount != 0 ? threadCount : std::max(1, (int)std::thread::hardware_concurrency());
+	this->parallelLevels = 0;
+	if (expansionsPerSlice == 0) finish();
+}
+
+SearchTask ParallelBFS::search(void)
+{
+	PassabilityMap map(parentMaze); // Read-only from every thread
+	int ySize = parentMaze->getYSize();
+	int cellCount = parentMaze->getXSize() * ySize;
+	std::vector<int> goalIndices = parentMaze->getGoalIndices();
+	if (!map.get(parentMaze->getStartX(), parentMaze->getStartY())) co_return;
+	int startIndex = parentMaze->getStartX() * ySize + parentMaze->getStartY();
+	std::vector<std::atomic<int>> parents(cellCount);
+	for (int i = 0; i < cellCount; i++) parents[i].store(-1, std::memory_order_relaxed);
+	parents[startIndex].store(startIndex, std::memory_order_relaxed);
+
+	// Each thread appends to its own next-frontier buffer. The buffers aren't merged; the next level treats them as one list via
+	// prefix offsets and threads claim chunks of it with an atomic cursor, so nothing needs a lock.
+	std::vector<std::vector<int>> current(threadCount), next(threadCount);
+	std::vector<size_t> offsets(threadCount + 1, 0);
+	std::atomic<size_t> cursor(0);
+	current[0].push_back(startIndex);
+	marks[startIndex] = FRONTIER;
+	bool finished = false;
+	LevelBarrier barrier(threadCount);
+	auto expandLevel = [&](int thread)
+	{
+		next[thread].clear();
+		size_t total = offsets[threadCount];
+		int buffer = 0;
+		for (size_t chunk = cursor.fetch_add(CHUNK_SIZE); chunk < total; chunk = cursor.fetch_add(CHUNK_SIZE))
+		{
+			size_t end = std::min(chunk + CHUNK_SIZE, total);
+			for (size_t i = chunk; i < end; i++)
+			{
+				while (offsets[buffer + 1] <= i) buffer++; // A thread's chunks only ever move forward, so neither does this
+				int index = current[buffer][i - offsets[buffer]];
+				marks[index] = VISITED; // Each space is expanded and claimed exactly once, so no two threads write the same mark
+				for (int neighbour : map.getOpenNeighbours(index / ySize, index % ySize))
+				{
+					int unclaimed = -1;
+					if (parents[neighbour].load(std::memory_order_relaxed) != -1) continue;
+					if (!parents[neighbour].compare_exchange_strong(unclaimed, index, std::memory_order_relaxed)) continue;
+					next[thread].push_back(neighbour);
+					marks[neighbour] = FRONTIER;
+				}
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	PoolShutdown shutdown(finished, barrier, workers);
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		workers.push_back(std::thread([&, thread]()
+		{
+			while (true)
+			{
+				barrier.arriveAndWait();
+				if (finished) return;
+				expandLevel(thread);
+				barrier.arriveAndWait();
+			}
+		}));
+	}
+	auto findReachedGoal = [&]() // Checked between levels, so whichever it finds is one of the nearest
+	{
+		for (int goalIndex : goalIndices)
+		{
+			if (parents[goalIndex].load(std::memory_order_relaxed) != -1) return goalIndex;
+		}
+		return -1;
+	};
+	int sliceExpansions = 0;
+	while (findReachedGoal() == -1)
+	{
+		for (int thread = 0; thread < threadCount; thread++) offsets[thread + 1] = offsets[thread] + current[thread].size();
+		if (offsets[threadCount] == 0) break;
+		examinedNodes += (int)offsets[threadCount];
+		cursor.store(0);
+		if (offsets[threadCount] < PARALLEL_THRESHOLD || threadCount == 1)
+		{
+			for (std::vector<int>& buffer : next) buffer.clear();
+			expandLevel(0);
+		}
+		else
+		{
+			barrier.arriveAndWait(); // The barrier's mutex also publishes this level's offsets and the last level's claims
+			expandLevel(0);
+			barrier.arriveAndWait();
+			parallelLevels++;
+		}
+		std::swap(current, next);
+		sliceExpansions += (int)offsets[threadCount];
+		if (expansionsPerSlice != 0 && sliceExpansions >= expansionsPerSlice)
+		{
+			sliceExpansions = 0;
+			co_yield examinedNodes;
+		}
+	}
+	shutdown.stop();
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	int goalIndex = findReachedGoal();
+	if (goalIndex == -1) co_return;
+	std::vector<int> path;
+	for (int index = goalIndex; index != startIndex; index = parents[index].load()) path.push_back(index);
+	path.push_back(startIndex);
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+int ParallelBFS::getThreadCount(void)
+{
+	return this->threadCount;
+}
+
+int ParallelBFS::getParallelLevelCount(void)
+{
+	return this->parallelLevels;
+}
+
+DeltaStepping::DeltaStepping(Maze* maze, int delta, int threadCount) : PathSolver(maze)
+{
+	if (delta < 0) throw std::invalid_argument("Delta can't be negative!");
+	if (threadCount < 0) throw std::invalid_argument("Thread count can't be negative!");
+	this->delta = delta;
+	this->threadCount = threadCount != 0 ? threadCount : std::max(1, (int)std::thread::hardware_concurrency());
+	findShortestPath();
+}
+
+void DeltaStepping::findShortestPath(void)
+{
+	int ySize = parentMaze->getYSize();
+	int cellCount = parentMaze->getXSize() * ySize;
+	std::vector<int> goalIndices = parentMaze->getGoalIndices();
+	if (!parentMaze->isPassable(parentMaze->getStartX(), parentMaze->getStartY())) return;
+	int startIndex = parentMaze->getStartX() * ySize + parentMaze->getStartY();
+	std::vector<int> costs(cellCount, 0); // Read from every thread, so copy them out of the Spaces first
+	int maxCost = 1;
+	for (int index = 0; index < cellCount; index++)
+	{
+		if (!parentMaze->isPassable(index / ySize, index % ySize)) continue;
+		costs[index] = parentMaze->getCost(index / ySize, index % ySize);
+		maxCost = std::max(maxCost, costs[index]);
+	}
+	if (delta == 0) delta = std::max(1, maxCost / 2);
+
+	// Distance in the top half, parent in the bottom, so a thread that lowers a distance always leaves the matching parent behind
+	const uint64_t UNLABELLED = ~(uint64_t)0;
+	std::vector<std::atomic<uint64_t>> labels(cellCount);
+	for (int index = 0; index < cellCount; index++) labels[index].store(UNLABELLED, std::memory_order_relaxed);
+	labels[startIndex].store((uint64_t)startIndex, std::memory_order_relaxed); // Distance 0, and its own parent
+	auto findNearestGoal = [&]() // Lowest label is lowest distance, -1 until some goal has been reached
+	{
+		int nearest = -1;
+		for (int goalIndex : goalIndices)
+		{
+			uint64_t label = labels[goalIndex].load(std::memory_order_relaxed);
+			if (label != UNLABELLED && (nearest == -1 || label < labels[nearest].load(std::memory_order_relaxed))) nearest = goalIndex;
+		}
+		return nearest;
+	};
+
+	// Tentative distances never run more than maxCost past the bucket being settled, so a small ring of buckets is enough
+	int bucketCount = maxCost / delta + 2;
+	std::vector<std::vector<int>> buckets(bucketCount);
+	buckets[0].push_back(startIndex);
+	std::vector<std::vector<int>> improved(threadCount); // Per-thread lists of spaces whose distance went down
+	std::vector<int> work;
+	std::atomic<size_t> cursor(0);
+	bool lightPhase = true;
+	bool finished = false;
+	LevelBarrier barrier(threadCount);
+	auto relax = [&](int thread)
+	{
+		improved[thread].clear();
+		for (size_t chunk = cursor.fetch_add(CHUNK_SIZE); chunk < work.size(); chunk = cursor.fetch_add(CHUNK_SIZE))
+		{
+			size_t end = std::min(chunk + CHUNK_SIZE, work.size());
+			for (size_t i = chunk; i < end; i++)
+			{
+				int index = work[i];
+				uint64_t distance = labels[index].load(std::memory_order_relaxed) >> 32;
+				for (int neighbour : parentMaze->getOpenNeighbours(index / ySize, index % ySize))
+				{
+					if ((costs[neighbour] <= delta) != lightPhase) continue;
+					uint64_t newDistance = distance + costs[neighbour];
+					uint64_t proposed = (newDistance << 32) | (uint32_t)index;
+					uint64_t seen = labels[neighbour].load(std::memory_order_relaxed);
+					while ((seen >> 32) > newDistance) // A failed exchange reloads seen, so this retries only while we'd still improve it
+					{
+						if (labels[neighbour].compare_exchange_weak(seen, proposed, std::memory_order_relaxed))
+						{
+							improved[thread].push_back(neighbour);
+							break;
+						}
+					}
+				}
+			}
+		}
+	};
+	auto runPhase = [&](bool light)
+	{
+		examinedNodes += (int)work.size();
+		lightPhase = light;
+		cursor.store(0);
+		if (work.size() < PARALLEL_THRESHOLD || threadCount == 1)
+		{
+			for (std::vector<int>& list : improved) list.clear();
+			relax(0);
+		}
+		else
+		{
+			barrier.arriveAndWait();
+			relax(0);
+			barrier.arriveAndWait();
+		}
+		for (std::vector<int>& list : improved)
+		{
+			for (int index : list) buckets[(labels[index].load(std::memory_order_relaxed) >> 32) / delta % bucketCount].push_back(index);
+		}
+	};
+	std::vector<std::thread> workers;
+	for (int thread = 1; thread < threadCount; thread++)
+	{
+		workers.push_back(std::thread([&, thread]()
+		{
+			while (true)
+			{
+				barrier.arriveAndWait();
+				if (finished) return;
+				relax(thread);
+				barrier.arriveAndWait();
+			}
+		}));
+	}
+	std::vector<int> settled;
+	for (uint64_t bucket = 0; ; bucket++)
+	{
+		bool anyLeft = false;
+		for (std::vector<int>& list : buckets) anyLeft = anyLeft || !list.empty();
+		if (!anyLeft) break;
+		std::vector<int>& current = buckets[bucket % bucketCount];
+		settled.clear();
+		while (!current.empty())
+		{
+			work.clear();
+			for (int index : current)
+			{
+				if ((labels[index].load(std::memory_order_relaxed) >> 32) / delta == bucket) work.push_back(index); // Skip spaces that have since moved to a lower bucket
+			}
+			current.clear();
+			settled.insert(settled.end(), work.begin(), work.end());
+			runPhase(true);
+		}
+		work = settled;
+		runPhase(false);
+		int goalIndex = findNearestGoal();
+		if (goalIndex != -1 && (labels[goalIndex].load(std::memory_order_relaxed) >> 32) / delta <= bucket) break; // Everything below the next bucket is final now
+	}
+	finished = true;
+	if (!workers.empty()) barrier.arriveAndWait();
+	for (std::thread& worker : workers) worker.join();
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	int goalIndex = findNearestGoal();
+	if (goalIndex == -1) return;
+	std::vector<int> path;
+	for (int index = goalIndex; index != startIndex; index = (int)(uint32_t)labels[index].load()) path.push_back(index);
+	path.push_back(startIndex);
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+int DeltaStepping::getDelta(void)
+{
+	return this->delta;
+}
+
+int DeltaStepping::getThreadCount(void)
+{
+	return this->threadCount;
+}
+
+static std::vector<std::pair<int, int>> getRouteEnds(Maze* maze) // The start and every goal, for graphs and fillers that have to keep them
+{
+	std::vector<std::pair<int, int>> cells = maze->getGoals();
+	cells.push_back(std::make_pair(maze->getStartX(), maze->getStartY()));
+	return cells;
+}
+
+static bool runHeapSearch(Maze* maze, const std::atomic<bool>& cancelled, std::vector<int>& path, int& examined, bool useHeuristic) // Dijkstra, or A* with the Manhattan heuristic
+{
+	int ySize = maze->getYSize();
+	int goalIndex = -1;
+	if (!maze->isPassable(maze->getStartX(), maze->getStartY())) return false;
+	int startIndex = maze->getStartX() * ySize + maze->getStartY();
+	std::vector<int> distances(maze->getXSize() * ySize, INT_MAX);
+	std::vector<int> previous(distances.size(), -1);
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> openList; // (distance + heuristic, index)
+	distances[startIndex] = 0;
+	openList.push(std::make_pair(0, startIndex));
+	while (!openList.empty())
+	{
+		if ((examined & 1023) == 0 && cancelled.load(std::memory_order_relaxed)) return false;
+		int index = openList.top().second;
+		int priority = openList.top().first;
+		openList.pop();
+		int heuristic = useHeuristic ? maze->getGoalHeuristic(index / ySize, index % ySize) : 0;
+		if (priority > distances[index] + heuristic) continue;
+		examined++;
+		if (maze->isGoal(index / ySize, index % ySize))
+		{
+			goalIndex = index;
+			break;
+		}
+		for (int neighbour : maze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			int distance = distances[index] + maze->getCost(neighbour / ySize, neighbour % ySize);
+			if (distance >= distances[neighbour]) continue;
+			distances[neighbour] = distance;
+			previous[neighbour] = index;
+			int neighbourHeuristic = useHeuristic ? maze->getGoalHeuristic(neighbour / ySize, neighbour % ySize) : 0;
+			openList.push(std::make_pair(distance + neighbourHeuristic, neighbour));
+		}
+	}
+	if (goalIndex == -1) return false;
+	for (int index = goalIndex; index != -1; index = previous[index]) path.push_back(index);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+static bool runFloodFill(Maze* maze, const std::atomic<bool>& cancelled, std::vector<int>& path, int& examined) // Floods out from every goal, then rolls downhill from the start
+{
+	int ySize = maze->getYSize();
+	if (!maze->isPassable(maze->getStartX(), maze->getStartY())) return false;
+	int startIndex = maze->getStartX() * ySize + maze->getStartY();
+	std::vector<int> flood(maze->getXSize() * ySize, -1);
+	std::vector<int> frontier = maze->getGoalIndices();
+	for (int goalIndex : frontier) flood[goalIndex] = 0;
+	for (size_t next = 0; next < frontier.size() && flood[startIndex] == -1; next++)
+	{
+		if ((next & 1023) == 0 && cancelled.load(std::memory_order_relaxed)) return false;
+		int index = frontier[next];
+		examined++;
+		for (int neighbour : maze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (flood[neighbour] != -1) continue;
+			flood[neighbour] = flood[index] + 1;
+			frontier.push_back(neighbour);
+		}
+	}
+	if (flood[startIndex] == -1) return false;
+	path.push_back(startIndex);
+	while (flood[path.back()] != 0)
+	{
+		int index = path.back();
+		for (int neighbour : maze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (flood[neighbour] == flood[index] - 1)
+			{
+				path.push_back(neighbour);
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+static bool runDeadEndFilling(Maze* maze, const std::atomic<bool>& cancelled, std::vector<int>& path, int& examined) // Only checks the flag between filling and searching
+{
+	int ySize = maze->getYSize();
+	std::pair<int, int> start(maze->getStartX(), maze->getStartY());
+	int startIndex = start.first * ySize + start.second;
+	int goalIndex = -1;
+	DeadEndFiller filler(maze, getRouteEnds(maze));
+	PassabilityMap* mask = filler.getMask();
+	if (cancelled.load() || !mask->get(start.first, start.second)) return false;
+	std::vector<int> previous(maze->getXSize() * ySize, -1);
+	std::vector<int> frontier(1, startIndex);
+	previous[startIndex] = startIndex;
+	for (size_t next = 0; next < frontier.size(); next++)
+	{
+		int index = frontier[next];
+		examined++;
+		if (maze->isGoal(index / ySize, index % ySize))
+		{
+			goalIndex = index;
+			break;
+		}
+		for (int neighbour : mask->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (previous[neighbour] != -1) continue;
+			previous[neighbour] = index;
+			frontier.push_back(neighbour);
+		}
+	}
+	if (goalIndex == -1) return false;
+	for (int index = goalIndex; index != startIndex; index = previous[index]) path.push_back(index);
+	path.push_back(startIndex);
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+PortfolioSolver::PortfolioSolver(Maze* maze) : PortfolioSolver(maze, getDefaultEngines(maze))
+{
+}
+
+PortfolioSolver::PortfolioSolver(Maze* maze, std::vector<PortfolioEngine> engines) : PathSolver(maze)
+{
+	if (engines.empty()) throw std::invalid_argument("A portfolio needs at least one engine!");
+	this->winningTime = 0;
+	race(engines);
+}
+
+std::vector<PortfolioEngine> PortfolioSolver::getDefaultEngines(Maze* maze)
+{
+	bool unitCosts = true;
+	for (int x = 0; x < maze->getXSize() && unitCosts; x++)
+	{
+		for (int y = 0; y < maze->getYSize(); y++)
+		{
+			if (maze->isPassable(x, y) && maze->getCost(x, y) != 1) unitCosts = false;
+		}
+	}
+	std::vector<PortfolioEngine> engines;
+	engines.push_back({ "Dijkstra", [](Maze* maze, const std::atomic<bool>& cancelled, std::vector<int>& path, int& examined) { return runHeapSearch(maze, cancelled, path, examined, false); } });
+	engines.push_back({ "AStar", [](Maze* maze, const std::atomic<bool>& cancelled, std::vector<int>& path, int& examined) { return runHeapSearch(maze, cancelled, path, examined, true); } });
+	if (unitCosts) // These two count moves rather than cost, so they'd find the wrong route across terrain
+	{
+		engines.push_back({ "FloodFill", runFloodFill });
+		engines.push_back({ "DeadEndFilling", runDeadEndFilling });
+	}
+	return engines;
+}
+
+void PortfolioSolver::race(std::vector<PortfolioEngine>& engines)
+{
+	std::atomic<bool> cancelled(false);
+	std::mutex resultLock;
+	std::vector<int> winningPath;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < engines.size(); i++)
+	{
+		threads.push_back(std::thread([&, i]()
+		{
+			std::vector<int> path;
+			int examined = 0;
+			bool found = false;
+			try
+			{
+				found = engines[i].run(parentMaze, cancelled, path, examined);
+			}
+			catch (std::exception&) // An engine that throws just drops out of the race
+			{
+				found = false;
+			}
+			if (!found) return;
+			std::lock_guard<std::mutex> guard(resultLock);
+			if (!winner.empty()) return;
+			winner = engines[i].name;
+			winningTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			winningPath.swap(path);
+			examinedNodes = examined;
+			cancelled.store(true);
+		}));
+	}
+	for (std::thread& thread : threads) thread.join();
+	if (winner.empty())
+	{
+		std::cout << "No engine in the portfolio found a route" << std::endl;
+		return;
+	}
+	std::cout << "Portfolio winner: " << winner << " after " << winningTime * 1000 << " ms" << std::endl;
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	setRoute(winningPath);
+}
+
+std::string PortfolioSolver::getWinner(void)
+{
+	return this->winner;
+}
+
+double PortfolioSolver::getWinningTime(void)
+{
+	return this->winningTime;
+}
+
+IDAStar::IDAStar(Maze* maze, int transpositionEntries, bool usePathBits) : PathSolver(maze)
+{
+	if (transpositionEntries < 0) throw std::invalid_argument("Transposition cache size can't be negative!");
+	this->usePathBits = usePathBits;
+	this->iterations = 0;
+	if (usePathBits) onPathBits.assign(maze->getXSize() * maze->getYSize(), false);
+	int size = 1;
+	while (size < transpositionEntries) size *= 2;
+	if (transpositionEntries > 0) transpositions.assign(size, { -1, 0, 0 });
+	findShortestPath();
+}
+
+bool IDAStar::isTransposition(int index, int distance)
+{
+	if (transpositions.empty()) return false;
+	Transposition& entry = transpositions[((uint32_t)index * 2654435761u) & (transpositions.size() - 1)];
+	if (entry.index == index && entry.iteration == iterations && entry.distance <= distance) return true; // Everything below it within the bound has already been searched
+	entry.index = index;
+	entry.distance = distance;
+	entry.iteration = iterations;
+	return false;
+}
+
+int IDAStar::getHeuristic(int index)
+{
+	int ySize = parentMaze->getYSize();
+	return parentMaze->getGoalHeuristic(index / ySize, index % ySize);
+}
+
+IDAStar::Frame IDAStar::makeFrame(int index, int distance)
+{
+	int ySize = parentMaze->getYSize();
+	Frame frame;
+	frame.index = index;
+	frame.distance = distance;
+	frame.neighbourCount = 0;
+	frame.nextNeighbour = 0;
+	for (int neighbour : parentMaze->getOpenNeighbours(index / ySize, index % ySize)) // Insertion sort, there are at most four
+	{
+		int position = frame.neighbourCount++;
+		while (position > 0 && getHeuristic(frame.neighbours[position - 1]) > getHeuristic(neighbour))
+		{
+			frame.neighbours[position] = frame.neighbours[position - 1];
+			position--;
+		}
+		frame.neighbours[position] = neighbour;
+	}
+	return frame;
+}
+
+void IDAStar::setOnPath(int index, bool onPath)
+{
+	if (usePathBits) onPathBits[index] = onPath;
+	else if (onPath) onPathSet.insert(index);
+	else onPathSet.erase(index);
+}
+
+bool IDAStar::isOnPath(int index)
+{
+	if (usePathBits) return onPathBits[index];
+	return onPathSet.count(index) != 0;
+}
+
+void IDAStar::findShortestPath(void)
+{
+	int ySize = parentMaze->getYSize();
+	if (!parentMaze->isPassable(parentMaze->getStartX(), parentMaze->getStartY())) return;
+	int startIndex = parentMaze->getStartX() * ySize + parentMaze->getStartY();
+	std::vector<Frame> stack; // The current path, start first
+	int bound = getHeuristic(startIndex);
+	bool found = false;
+	while (!found && bound != INT_MAX)
+	{
+		iterations++;
+		int nextBound = INT_MAX;
+		stack.clear();
+		stack.push_back(makeFrame(startIndex, 0));
+		setOnPath(startIndex, true);
+		isTransposition(startIndex, 0);
+		while (!stack.empty())
+		{
+			Frame& top = stack.back();
+			if (parentMaze->isGoal(top.index / ySize, top.index % ySize))
+			{
+				found = true;
+				break;
+			}
+			if (top.nextNeighbour == top.neighbourCount)
+			{
+				setOnPath(top.index, false);
+				stack.pop_back();
+				continue;
+			}
+			int neighbour = top.neighbours[top.nextNeighbour++];
+			if (isOnPath(neighbour)) continue;
+			int distance = top.distance + parentMaze->getCost(neighbour / ySize, neighbour % ySize);
+			int estimate = distance + getHeuristic(neighbour);
+			if (estimate > bound)
+			{
+				nextBound = std::min(nextBound, estimate);
+				continue;
+			}
+			if (isTransposition(neighbour, distance)) continue;
+			examinedNodes++;
+			stack.push_back(makeFrame(neighbour, distance)); // top is invalid after this
+			setOnPath(neighbour, true);
+		}
+		if (!found)
+		{
+			bound = nextBound;
+			continue;
+		}
+		for (Frame& frame : stack) setOnPath(frame.index, false);
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (!found) return;
+	std::vector<int> path;
+	for (Frame& frame : stack) path.push_back(frame.index);
+	setRoute(path);
+}
+
+int IDAStar::getIterationCount(void)
+{
+	return this->iterations;
+}
+
+AnytimeAStar::AnytimeAStar(Maze* maze, double frameBudgetMilliseconds, double initialEpsilon, double epsilonStep)
+{
+	if (initialEpsilon < 1) throw std::invalid_argument("The heuristic can't be inflated by less than 1!");
+	if (epsilonStep <= 0) throw std::invalid_argument("Epsilon has to go down by something each pass!");
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->frameBudget = std::chrono::microseconds((long long)(frameBudgetMilliseconds * 1000));
+	this->epsilon = initialEpsilon;
+	this->epsilonStep = epsilonStep;
+	this->carIndex = maze->getStartX() * maze->getYSize() + maze->getStartY();
+	this->targetIndex = carIndex;
+	this->examinedNodes = 0;
+	this->passFinished = false;
+	this->routeFound = false;
+	this->optimal = false;
+	int cellCount = maze->getXSize() * maze->getYSize();
+	distances.assign(cellCount, INT_MAX);
+	parents.assign(cellCount, -1);
+	states.assign(cellCount, UNSEEN);
+	for (int goalIndex : maze->getGoalIndices()) // Seeded from every goal, so the route leads to whichever is cheapest to reach
+	{
+		distances[goalIndex] = 0;
+		states[goalIndex] = OPEN;
+		openList.push(std::make_pair(getKey(goalIndex), goalIndex));
+	}
+	spendBudget(); // Only one frame's worth, so construction never holds up the window
+}
+
+double AnytimeAStar::getKey(int index)
+{
+	int ySize = parentMaze->getYSize();
+	int heuristic = abs(index / ySize - targetIndex / ySize) + abs(index % ySize - targetIndex % ySize);
+	return distances[index] + epsilon * heuristic;
+}
+
+void AnytimeAStar::startPass(void) // Lower epsilon, reopen the inconsistent spaces and re-key everything against where the car is now
+{
+	epsilon = std::max(1.0, epsilon - epsilonStep);
+	targetIndex = carIndex;
+	openList = std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>>();
+	for (int index = 0; index < (int)states.size(); index++)
+	{
+		if (states[index] == OPEN || states[index] == INCONSISTENT)
+		{
+			states[index] = OPEN;
+			openList.push(std::make_pair(getKey(index), index));
+		}
+		else if (states[index] == CLOSED) states[index] = UNSEEN;
+	}
+	inconsistent.clear();
+	passFinished = false;
+}
+
+bool AnytimeAStar::improvePath(std::chrono::steady_clock::time_point deadline)
+{
+	int ySize = parentMaze->getYSize();
+	int expanded = 0;
+	while (!openList.empty())
+	{
+		double key = openList.top().first;
+		int index = openList.top().second;
+		if (states[index] != OPEN || key != getKey(index))
+		{
+			openList.pop();
+			continue;
+		}
+		if (distances[targetIndex] != INT_MAX && key >= distances[targetIndex]) return true; // Nothing left could beat the target's cost
+		if ((++expanded & 255) == 0 && std::chrono::steady_clock::now() >= deadline) return false;
+		openList.pop();
+		states[index] = CLOSED;
+		examinedNodes++;
+		int stepCost = parentMaze->getCost(index / ySize, index % ySize); // Moving from a neighbour onto this space
+		for (int neighbour : parentMaze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			if (distances[neighbour] <= distances[index] + stepCost) continue;
+			distances[neighbour] = distances[index] + stepCost;
+			parents[neighbour] = index;
+			if (states[neighbour] == CLOSED)
+			{
+				states[neighbour] = INCONSISTENT;
+				inconsistent.push_back(neighbour);
+			}
+			else if (states[neighbour] != INCONSISTENT)
+			{
+				states[neighbour] = OPEN;
+				openList.push(std::make_pair(getKey(neighbour), neighbour));
+			}
+		}
+	}
+	return true;
+}
+
+void AnytimeAStar::spendBudget(void)
+{
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + frameBudget;
+	while (!optimal && std::chrono::steady_clock::now() < deadline)
+	{
+		if (!passFinished) passFinished = improvePath(deadline);
+		if (!passFinished) return;
+		if (!routeFound && distances[targetIndex] != INT_MAX)
+		{
+			routeFound = true;
+			std::cout << "Found solution after examining " << examinedNodes << " nodes (within " << epsilon << "x of the best route)" << std::endl;
+		}
+		if (epsilon == 1 || distances[targetIndex] == INT_MAX) // Optimal, or there's no way through at all
+		{
+			optimal = true;
+			if (routeFound) std::cout << "Route is optimal after examining " << examinedNodes << " nodes" << std::endl;
+			return;
+		}
+		startPass();
+	}
+}
+
+void AnytimeAStar::MoveToNext(void)
+{
+	spendBudget();
+	if (!routeFound || parents[carIndex] == -1) return; // No route yet, or already at the goal
+	carIndex = parents[carIndex];
+	int ySize = parentMaze->getYSize();
+	this->parentCar->SetPos(carIndex / ySize, carIndex % ySize);
+}
+
+double AnytimeAStar::getEpsilon(void)
+{
+	return this->epsilon;
+}
+
+bool AnytimeAStar::hasRoute(void)
+{
+	return this->routeFound;
+}
+
+bool AnytimeAStar::isOptimal(void)
+{
+	return this->optimal;
+}
+
+int AnytimeAStar::getExaminedNodes(void)
+{
+	return this->examinedNodes;
+}
+
+SearchTask SearchTask::promise_type::get_return_object(void)
+{
+	return SearchTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+std::suspend_always SearchTask::promise_type::initial_suspend(void) noexcept
+{
+	return std::suspend_always();
+}
+
+std::suspend_always SearchTask::promise_type::final_suspend(void) noexcept // Stay suspended at the end so the handle can still be asked if it's done
+{
+	return std::suspend_always();
+}
+
+std::suspend_always SearchTask::promise_type::yield_value(int) noexcept
+{
+	return std::suspend_always();
+}
+
+void SearchTask::promise_type::return_void(void)
+{
+
+}
+
+void SearchTask::promise_type::unhandled_exception(void)
+{
+	this->exception = std::current_exception();
+}
+
+SearchTask::SearchTask(std::coroutine_handle<promise_type> handle)
+{
+	this->handle = handle;
+}
+
+SearchTask::SearchTask(SearchTask&& other) noexcept
+{
+	this->handle = other.handle;
+	other.handle = NULL;
+}
+
+SearchTask::~SearchTask(void)
+{
+	if (this->handle) this->handle.destroy();
+}
+
+bool SearchTask::resume(void)
+{
+	if (!this->handle || this->handle.done()) return false;
+	this->handle.resume();
+	if (this->handle.promise().exception) std::rethrow_exception(this->handle.promise().exception);
+	return !this->handle.done();
+}
+
+bool SearchTask::isDone(void)
+{
+	return !this->handle || this->handle.done();
+}
+
+SteppedSolver::SteppedSolver(Maze* maze, int expansionsPerSlice) : PathSolver(maze)
+{
+	if (expansionsPerSlice < 0) throw std::invalid_argument("A slice can't expand a negative number of nodes!");
+	this->expansionsPerSlice = expansionsPerSlice;
+	this->marks.assign(maze->getXSize() * maze->getYSize(), UNSEEN);
+	this->task = NULL;
+	this->cancelled = false;
+}
+
+SteppedSolver::~SteppedSolver(void)
+{
+	delete this->task;
+}
+
+void SteppedSolver::restart(void)
+{
+	delete this->task;
+	this->task = NULL;
+	this->cancelled = false;
+	this->examinedNodes = 0;
+	std::fill(this->marks.begin(), this->marks.end(), UNSEEN);
+	while (!route.empty()) route.pop();
+}
+
+bool SteppedSolver::runSlice(void)
+{
+	if (this->cancelled) return false;
+	if (this->task == NULL) this->task = new SearchTask(search());
+	return this->task->resume();
+}
+
+void SteppedSolver::finish(void)
+{
+	while (runSlice());
+}
+
+void SteppedSolver::cancel(void)
+{
+	if (!isSearching()) return;
+	this->cancelled = true;
+	delete this->task; // Destroying the suspended coroutine frees everything the search had allocated
+	this->task = NULL;
+	std::cout << "Search cancelled after examining " << examinedNodes << " nodes" << std::endl;
+}
+
+bool SteppedSolver::isSearching(void)
+{
+	return !this->cancelled && (this->task == NULL || !this->task->isDone());
+}
+
+bool SteppedSolver::isCancelled(void)
+{
+	return this->cancelled;
+}
+
+SteppedSolver::SearchMark SteppedSolver::getMark(int x, int y)
+{
+	if (x < 0 || x >= parentMaze->getXSize() || y < 0 || y >= parentMaze->getYSize()) throw std::out_of_range("Index out of range");
+	return (SearchMark)this->marks[x * parentMaze->getYSize() + y];
+}
+
+void SteppedSolver::MoveToNext(void)
+{
+	if (runSlice()) return;
+	PathSolver::MoveToNext();
+}
+
+SteppedAStar::SteppedAStar(Maze* maze, int expansionsPerSlice, bool useHeuristic) : SteppedSolver(maze, expansionsPerSlice)
+{
+	this->useHeuristic = useHeuristic;
+}
+
+SearchTask SteppedAStar::search(void)
+{
+	int ySize = parentMaze->getYSize();
+	int goalIndex = -1;
+	std::vector<int> distances(marks.size(), INT_MAX);
+	std::vector<int> parents(marks.size(), -1);
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> openList;
+	int startIndex = parentMaze->getStartX() * ySize + parentMaze->getStartY();
+	distances[startIndex] = 0;
+	marks[startIndex] = FRONTIER;
+	openList.push(std::make_pair(0, startIndex));
+	int sliceExpansions = 0;
+	while (!openList.empty())
+	{
+		int index = openList.top().second;
+		openList.pop();
+		if (marks[index] == VISITED) continue; // Stale entry, the heuristic is consistent so the first pop was already the cheapest
+		marks[index] = VISITED;
+		examinedNodes++;
+		if (parentMaze->isGoal(index / ySize, index % ySize))
+		{
+			goalIndex = index;
+			break;
+		}
+		for (int neighbour : parentMaze->getOpenNeighbours(index / ySize, index % ySize))
+		{
+			int distance = distances[index] + parentMaze->getCost(neighbour / ySize, neighbour % ySize);
+			if (distance >= distances[neighbour]) continue;
+			distances[neighbour] = distance;
+			parents[neighbour] = index;
+			marks[neighbour] = FRONTIER;
+			int heuristic = useHeuristic ? parentMaze->getGoalHeuristic(neighbour / ySize, neighbour % ySize) : 0;
+			openList.push(std::make_pair(distance + heuristic, neighbour));
+		}
+		if (++sliceExpansions == expansionsPerSlice)
+		{
+			sliceExpansions = 0;
+			co_yield examinedNodes;
+		}
+	}
+	if (goalIndex == -1) co_return; // Nothing to follow, the car just stays put
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	std::vector<int> path;
+	for (int index = goalIndex; index != -1; index = parents[index]) path.push_back(index);
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+WallSensor::WallSensor(Maze* maze)
+{
+	this->parentMaze = maze;
+	this->scanned = std::vector<bool>(maze->getXSize() * maze->getYSize(), false);
+	this->observed = std::vector<bool>(maze->getXSize() * maze->getYSize(), false);
+	this->cellsExplored = 0;
+	this->wallsFound = 0;
+	this->scanCount = 0;
+}
+
+bool WallSensor::scan(int x, int y, PassabilityMap* knownMap)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	bool foundWall = false;
+	scanCount++;
+	if (!scanned[x * parentMaze->getYSize() + y])
+	{
+		scanned[x * parentMaze->getYSize() + y] = true;
+		observed[x * parentMaze->getYSize() + y] = true;
+		cellsExplored++;
+	}
+	for (int direction = 0; direction < 4; direction++)
+	{
+		int neighbourX = x + xOffsets[direction];
+		int neighbourY = y + yOffsets[direction];
+		if (neighbourX < 0 || neighbourY < 0 || neighbourX >= parentMaze->getXSize() || neighbourY >= parentMaze->getYSize()) continue;
+		observed[neighbourX * parentMaze->getYSize() + neighbourY] = true;
+		bool passable = parentMaze->isPassable(neighbourX, neighbourY);
+		if (passable == knownMap->get(neighbourX, neighbourY)) continue;
+		knownMap->set(neighbourX, neighbourY, passable); // Also picks up walls that have since been removed
+		if (!passable)
+		{
+			wallsFound++;
+			foundWall = true;
+		}
+	}
+	return foundWall;
+}
+
+bool WallSensor::hasObserved(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= parentMaze->getXSize() || y >= parentMaze->getYSize()) return false;
+	return this->observed[x * parentMaze->getYSize() + y];
+}
+
+int WallSensor::getCellsExplored(void)
+{
+	return this->cellsExplored;
+}
+
+int WallSensor::getWallsFound(void)
+{
+	return this->wallsFound;
+}
+
+long long WallSensor::getScanCount(void)
+{
+	return this->scanCount;
+}
+
+double MotionModel::getStraightTime(int cells) // Trapezoidal speed profile: accelerate from turnSpeed, cruise at maxSpeed if there's room, brake back to turnSpeed
+{
+	double distance = cells;
+	double rampDistance = (maxSpeed * maxSpeed - turnSpeed * turnSpeed) / (2.0 * acceleration);
+	if (2.0 * rampDistance >= distance) // Never reaches top speed - peaks halfway along
+	{
+		double peakSpeed = sqrt(turnSpeed * turnSpeed + acceleration * distance);
+		return 2.0 * (peakSpeed - turnSpeed) / acceleration;
+	}
+	return 2.0 * (maxSpeed - turnSpeed) / acceleration + (distance - 2.0 * rampDistance) / maxSpeed;
+}
+
+SpeedRunPlanner::SpeedRunPlanner(Maze* maze, PassabilityMap* knownMap, WallSensor* sensor, MotionModel motionModel) : PathSolver(maze)
+{
+	this->motionModel = motionModel;
+	this->passability = (knownMap != NULL) ? new PassabilityMap(*knownMap) : new PassabilityMap(maze);
+	this->sensor = sensor;
+	this->plannedTime = -1.0;
+	findFastestPath();
+}
+
+SpeedRunPlanner::~SpeedRunPlanner(void)
+{
+	delete this->passability;
+}
+
+bool SpeedRunPlanner::canUse(int x, int y)
+{
+	return passability->get(x, y) && (sensor == NULL || sensor->hasObserved(x, y));
+}
+
+// A state is (cell, heading) for a car that has just finished a straight and is about to turn. Every edge is a 90 degree turn
+// followed by a straight of k cells, so a straight is always costed as one run and never split into slower pieces.
+void SpeedRunPlanner::findFastestPath(void)
+{
+	int xSize = parentMaze->getXSize();
+	int ySize = parentMaze->getYSize();
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int startX = parentMaze->getStartX();
+	int startY = parentMaze->getStartY();
+	int startIndex = startX * ySize + startY;
+	if (!canUse(startX, startY)) return;
+	std::vector<double> straightTimes(std::max(xSize, ySize) + 1, 0.0);
+	for (int cells = 1; cells < (int)straightTimes.size(); cells++) straightTimes[cells] = motionModel.getStraightTime(cells);
+	std::vector<double> time(xSize * ySize * 4, -1.0);
+	std::vector<int> previous(xSize * ySize * 4, -1); // Previous state, or -2 for states reached straight from the start
+	std::vector<bool> done(xSize * ySize * 4, false);
+	std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> openList; // (time, state)
+	int goalState = -1;
+	if (parentMaze->isGoal(startX, startY)) goalState = startIndex * 4;
+	for (int heading = 0; heading < 4 && goalState == -1; heading++) // The first straight doesn't need a turn before it
+	{
+		for (int cells = 1; canUse(startX + cells * xOffsets[heading], startY + cells * yOffsets[heading]); cells++)
+		{
+			int state = ((startX + cells * xOffsets[heading]) * ySize + startY + cells * yOffsets[heading]) * 4 + heading;
+			time[state] = straightTimes[cells];
+			previous[state] = -2;
+			openList.push(std::make_pair(time[state], state));
+		}
+	}
+	while (!openList.empty() && goalState == -1)
+	{
+		int state = openList.top().second;
+		openList.pop();
+		if (done[state]) continue;
+		done[state] = true;
+		examinedNodes++;
+		int index = state / 4;
+		if (parentMaze->isGoal(index / ySize, index % ySize)) // The quickest goal to get to, not necessarily the closest
+		{
+			goalState = state;
+			break;
+		}
+		int x = index / ySize;
+		int y = index % ySize;
+		for (int turn = 1; turn <= 3; turn += 2) // Left or right, a U-turn never helps
+		{
+			int heading = (state % 4 + turn) % 4;
+			for (int cells = 1; canUse(x + cells * xOffsets[heading], y + cells * yOffsets[heading]); cells++)
+			{
+				int nextState = ((x + cells * xOffsets[heading]) * ySize + y + cells * yOffsets[heading]) * 4 + heading;
+				double nextTime = time[state] + motionModel.turnTime + straightTimes[cells];
+				if (done[nextState] || (time[nextState] >= 0.0 && time[nextState] <= nextTime)) continue;
+				time[nextState] = nextTime;
+				previous[nextState] = state;
+				openList.push(std::make_pair(nextTime, nextState));
+			}
+		}
+	}
+	std::cout << "Found speed run after examining " << examinedNodes << " states" << std::endl;
+	if (goalState == -1) return;
+	plannedTime = (goalState / 4 == startIndex) ? 0.0 : time[goalState];
+
+	std::vector<int> path(1, goalState / 4); // Fill in the cells along each straight, working back from the goal
+	for (int state = goalState; state >= 0 && state / 4 != startIndex; state = previous[state])
+	{
+		int fromIndex = (previous[state] >= 0) ? previous[state] / 4 : startIndex;
+		int x = state / 4 / ySize, y = state / 4 % ySize;
+		while (x * ySize + y != fromIndex)
+		{
+			x -= xOffsets[state % 4];
+			y -= yOffsets[state % 4];
+			path.push_back(x * ySize + y);
+		}
+	}
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+double SpeedRunPlanner::getPlannedTime(void)
+{
+	return this->plannedTime;
+}
+
+ExploreThenSpeedRun::ExploreThenSpeedRun(Maze* maze, MotionModel motionModel)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->explorer = new FloodFill(maze, true);
+	this->speedRun = NULL;
+	this->motionModel = motionModel;
+}
+
+ExploreThenSpeedRun::~ExploreThenSpeedRun(void)
+{
+	delete this->explorer;
+	delete this->speedRun;
+}
+
+void ExploreThenSpeedRun::MoveToNext(void)
+{
+	bool atGoal = parentMaze->isGoal(parentCar->GetX(), parentCar->GetY());
+	if (speedRun != NULL)
+	{
+		speedRun->MoveToNext();
+		return;
+	}
+	if (!atGoal)
+	{
+		explorer->MoveToNext();
+		return;
+	}
+	// Exploration is done. Like a real Micromouse, the car gets put back at the start for its speed run.
+	std::cout << "Explored " << explorer->getSensor()->getCellsExplored() << " cells in " << explorer->getMoveCount() << " moves, "
+		<< explorer->getRefloodCellCount() << " reflood steps, " << explorer->getAverageMoveTime() * 1e6 << " microseconds per move" << std::endl;
+	speedRun = new SpeedRunPlanner(parentMaze, explorer->getKnownMap(), explorer->getSensor(), motionModel);
+	std::cout << "Planned speed run of " << speedRun->getRouteLength() << " cells taking " << speedRun->getPlannedTime() << " seconds" << std::endl;
+	parentCar->SetPos(parentMaze->getStartX(), parentMaze->getStartY());
+}
+
+WallFollower::WallFollower(Maze* maze, bool leftHand, int heading)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->leftHand = leftHand;
+	this->heading = heading;
+}
+
+void WallFollower::MoveToNext(void) // Try the wall-side turn first, then straight on, then away from the wall, then back the way we came
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int x = parentCar->GetX();
+	int y = parentCar->GetY();
+	if (parentMaze->isGoal(x, y)) return;
+	const int leftTurns[4] = { 1, 0, 3, 2 };
+	const int rightTurns[4] = { 3, 0, 1, 2 };
+	for (int attempt = 0; attempt < 4; attempt++)
+	{
+		int direction = (heading + (leftHand ? leftTurns[attempt] : rightTurns[attempt])) % 4;
+		if (parentMaze->isPassable(x + xOffsets[direction], y + yOffsets[direction]))
+		{
+			heading = direction;
+			parentCar->SetPos(x + xOffsets[direction], y + yOffsets[direction]);
+			return;
+		}
+	}
+}
+
+Pledge::Pledge(Maze* maze, int preferredHeading)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	if (preferredHeading == -1)
+	{
+		std::pair<int, int> goal = maze->getGoals()[0];
+		for (std::pair<int, int> candidate : maze->getGoals()) // Only sets a heading, so the closest as the crow flies is good enough
+		{
+			if (abs(candidate.first - maze->getStartX()) + abs(candidate.second - maze->getStartY()) < abs(goal.first - maze->getStartX()) + abs(goal.second - maze->getStartY())) goal = candidate;
+		}
+		int dx = goal.first - maze->getStartX();
+		int dy = goal.second - maze->getStartY();
+		if (abs(dx) >= abs(dy)) preferredHeading = (dx >= 0) ? HEADING_EAST : HEADING_WEST;
+		else preferredHeading = (dy >= 0) ? HEADING_NORTH : HEADING_SOUTH;
+	}
+	this->preferredHeading = preferredHeading;
+	this->heading = preferredHeading;
+	this->turnCount = 0;
+	this->followingWall = false;
+}
+
+bool Pledge::tryMove(int direction)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int x = parentCar->GetX() + xOffsets[direction];
+	int y = parentCar->GetY() + yOffsets[direction];
+	if (!parentMaze->isPassable(x, y)) return false;
+	parentCar->SetPos(x, y);
+	return true;
+}
+
+void Pledge::MoveToNext(void)
+{
+	if (parentMaze->isGoal(parentCar->GetX(), parentCar->GetY())) return;
+	if (followingWall && turnCount == 0) followingWall = false; // Facing the preferred way again with no net turning, so let go of the wall
+	if (!followingWall)
+	{
+		heading = preferredHeading;
+		if (tryMove(heading)) return;
+		followingWall = true; // Blocked - turn right until there's a way on, which leaves the wall on our left
+		for (int turns = 1; turns <= 3; turns++)
+		{
+			heading = (heading + 3) % 4;
+			turnCount--;
+			if (tryMove(heading)) return;
+		}
+		return; // Boxed in on all four sides
+	}
+	const int turns[4] = { 1, 0, -1, -2 }; // Left-hand rule, with the turn each option adds to the count
+	for (int attempt = 0; attempt < 4; attempt++)
+	{
+		int direction = (heading + turns[attempt] + 4) % 4;
+		if (tryMove(direction))
+		{
+			heading = direction;
+			turnCount += turns[attempt];
+			return;
+		}
+	}
+}
+
+Tremaux::Tremaux(Maze* maze)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->marks = std::vector<uint8_t>((maze->getXSize() * maze->getYSize() + 3) / 4, 0);
+	setMark(maze->getStartX(), maze->getStartY(), 1);
+}
+
+int Tremaux::getMark(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= parentMaze->getXSize() || y >= parentMaze->getYSize()) return 2; // Off the edge counts as dead
+	int index = x * parentMaze->getYSize() + y;
+	return (marks[index / 4] >> ((index % 4) * 2)) & 3;
+}
+
+void Tremaux::setMark(int x, int y, int mark)
+{
+	int index = x * parentMaze->getYSize() + y;
+	marks[index / 4] = (uint8_t)((marks[index / 4] & ~(3 << ((index % 4) * 2))) | (mark << ((index % 4) * 2)));
+}
+
+bool Tremaux::touchesPathElsewhere(int x, int y, int fromX, int fromY)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	for (int direction = 0; direction < 4; direction++)
+	{
+		int neighbourX = x + xOffsets[direction];
+		int neighbourY = y + yOffsets[direction];
+		if ((neighbourX != fromX || neighbourY != fromY) && getMark(neighbourX, neighbourY) == 1) return true;
+	}
+	return false;
+}
+
+// Walking into a cell that touches the path anywhere else would close a loop, which is what Trémaux's "arrived at a marked junction,
+// turn back" rule is there to avoid. Skipping those cells keeps the path a simple chain, so when backtracking the only once-marked
+// neighbour is always the cell we came from. A skipped cell gets entered later from the oldest path cell it touches.
+void Tremaux::MoveToNext(void)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int x = parentCar->GetX();
+	int y = parentCar->GetY();
+	if (parentMaze->isGoal(x, y)) return;
+	int bestDirection = -1;
+	int backDirection = -1;
+	for (int direction = 0; direction < 4; direction++) // Only the four spaces beside the car are looked at, like a real wall sensor
+	{
+		int neighbourX = x + xOffsets[direction];
+		int neighbourY = y + yOffsets[direction];
+		if (!parentMaze->isPassable(neighbourX, neighbourY)) continue;
+		int mark = getMark(neighbourX, neighbourY);
+		if (mark == 1) backDirection = direction;
+		if (mark != 0 || touchesPathElsewhere(neighbourX, neighbourY, x, y)) continue;
+		if (bestDirection == -1 || parentMaze->getGoalHeuristic(neighbourX, neighbourY) < parentMaze->getGoalHeuristic(x + xOffsets[bestDirection], y + yOffsets[bestDirection])) bestDirection = direction;
+	}
+	if (bestDirection != -1) // Somewhere new - mark it once and go
+	{
+		setMark(x + xOffsets[bestDirection], y + yOffsets[bestDirection], 1);
+		parentCar->SetPos(x + xOffsets[bestDirection], y + yOffsets[bestDirection]);
+	}
+	else if (backDirection != -1) // Nothing new from here - mark this cell twice and go back the way we came
+	{
+		setMark(x, y, 2);
+		parentCar->SetPos(x + xOffsets[backDirection], y + yOffsets[backDirection]);
+	}
+}
+
+int Tremaux::getMemoryUsage(void)
+{
+	return (int)this->marks.size();
+}
+
+JumpPointSearch::JumpPointSearch(Maze* maze) : PathSolver(maze), passability(maze), goals(maze->getXSize(), maze->getYSize(), false)
+{
+	for (std::pair<int, int> goal : maze->getGoals()) goals.set(goal.first, goal.second, true);
+	findShortestPath();
+}
+
+// This is JPS for a 4-connected grid. Canonical paths move vertically first and only turn horizontal after that, so a horizontal run
+// only needs to stop where a vertical neighbour is "forced" (the cell beside it was open but the one beside the previous cell wasn't).
+// Along a row that test is (side & ~shifted side), which covers 64 cells per word along with the walls of the row itself.
+int JumpPointSearch::jumpHorizontal(int x, int y, int xDirection) // Returns the X of the next jump point along the row, or -1 if it hits a wall first
+{
+	int wordsPerRow = passability.getWordsPerRow();
+	int start = x + xDirection;
+	if (start < 0 || start >= passability.getXSize()) return -1;
+	for (int word = start / 64; word >= 0 && word < wordsPerRow; word += xDirection)
+	{
+		uint64_t row = passability.getWord(word, y);
+		uint64_t above = passability.getWord(word, y - 1);
+		uint64_t below = passability.getWord(word, y + 1);
+		uint64_t aboveBehind, belowBehind, window;
+		if (xDirection > 0) // Bit i of the "behind" words is the cell at i - 1
+		{
+			aboveBehind = (above << 1) | (passability.getWord(word - 1, y - 1) >> 63);
+			belowBehind = (below << 1) | (passability.getWord(word - 1, y + 1) >> 63);
+			window = (word == start / 64) ? ~(uint64_t)0 << (start % 64) : ~(uint64_t)0;
+		}
+		else // ...or at i + 1 when heading the other way
+		{
+			aboveBehind = (above >> 1) | (passability.getWord(word + 1, y - 1) << 63);
+			belowBehind = (below >> 1) | (passability.getWord(word + 1, y + 1) << 63);
+			window = (word == start / 64) ? ~(uint64_t)0 >> (63 - start % 64) : ~(uint64_t)0;
+		}
+		uint64_t jumpPoints = ((above & ~aboveBehind) | (below & ~belowBehind)) & row;
+		jumpPoints |= goals.getWord(word, y) & row; // Every goal is a jump point too
+		uint64_t stops = (jumpPoints | ~row) & window;
+		if (stops == 0) continue;
+		int bit = (xDirection > 0) ? lowestSetBit(stops) : highestSetBit(stops);
+		if ((jumpPoints >> bit) & 1) return word * 64 + bit;
+		return -1;
+	}
+	return -1;
+}
+
+int JumpPointSearch::jumpVertical(int x, int y, int yDirection) // Returns the Y of the next jump point up/down the column, or -1
+{
+	for (int j = y + yDirection; passability.get(x, j); j += yDirection)
+	{
+		if (goals.get(x, j)) return j;
+		if (jumpHorizontal(x, j, -1) != -1 || jumpHorizontal(x, j, 1) != -1) return j; // A horizontal branch leads somewhere useful
+	}
+	return -1;
+}
+
+void JumpPointSearch::findShortestPath(void)
+{
+	int xSize = parentMaze->getXSize();
+	int ySize = parentMaze->getYSize();
+	int startX = parentMaze->getStartX();
+	int startY = parentMaze->getStartY();
+	int startIndex = startX * ySize + startY;
+	int goalIndex = -1;
+	if (!passability.get(startX, startY)) return;
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	std::vector<int> distance(xSize * ySize, INT_MAX);
+	std::vector<int> previous(xSize * ySize, -1);
+	std::vector<int> arrivalDirection(xSize * ySize, -1);
+	std::vector<bool> closed(xSize * ySize, false);
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> openList; // (distance + heuristic, index)
+	distance[startIndex] = 0;
+	openList.push(std::make_pair(parentMaze->getGoalHeuristic(startX, startY), startIndex));
+	while (!openList.empty())
+	{
+		int index = openList.top().second;
+		openList.pop();
+		if (closed[index]) continue;
+		closed[index] = true;
+		examinedNodes++;
+		int x = index / ySize;
+		int y = index % ySize;
+		if (goals.get(x, y))
+		{
+			goalIndex = index;
+			break;
+		}
+		int arrived = arrivalDirection[index];
+		for (int direction = 0; direction < 4; direction++)
+		{
+			if (arrived != -1 && direction == (arrived + 2) % 4) continue; // Never go straight back
+			if (arrived == 0 || arrived == 2) // Arrived horizontally - only carry on, or turn if the turn is forced
+			{
+				if (direction == 1 || direction == 3)
+				{
+					if (!passability.get(x, y + yOffsets[direction]) || passability.get(x - xOffsets[arrived], y + yOffsets[direction])) continue;
+				}
+			}
+			int jumpX = x;
+			int jumpY = y;
+			if (xOffsets[direction] != 0) jumpX = jumpHorizontal(x, y, xOffsets[direction]);
+			else jumpY = jumpVertical(x, y, yOffsets[direction]);
+			if (jumpX == -1 || jumpY == -1) continue;
+			int jumpIndex = jumpX * ySize + jumpY;
+			int newDistance = distance[index] + abs(jumpX - x) + abs(jumpY - y);
+			if (closed[jumpIndex] || newDistance >= distance[jumpIndex]) continue;
+			distance[jumpIndex] = newDistance;
+			previous[jumpIndex] = index;
+			arrivalDirection[jumpIndex] = direction;
+			openList.push(std::make_pair(newDistance + parentMaze->getGoalHeuristic(jumpX, jumpY), jumpIndex));
+		}
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (goalIndex == -1) return;
+
+	std::vector<int> path; // Jump points are always in a straight line from each other, so fill in the cells between them
+	path.push_back(goalIndex);
+	for (int index = goalIndex; previous[index] != -1; index = previous[index])
+	{
+		int fromX = previous[index] / ySize, fromY = previous[index] % ySize;
+		int x = index / ySize, y = index % ySize;
+		while (x != fromX || y != fromY)
+		{
+			if (x != fromX) x += (fromX > x) ? 1 : -1;
+			else y += (fromY > y) ? 1 : -1;
+			path.push_back(x * ySize + y);
+		}
+	}
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+JunctionGraph::JunctionGraph(Maze* maze, std::vector<std::pair<int, int>> extraVertices)
+{
+	this->parentMaze = maze;
+	int xSize = maze->getXSize();
+	int ySize = maze->getYSize();
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	vertexIndex = std::vector<int>(xSize * ySize, -1);
+	for (int i = 0; i < xSize; i++) // Anything that isn't a plain two-way corridor cell becomes a vertex
+	{
+		for (int j = 0; j < ySize; j++)
+		{
+			if (maze->isPassable(i, j) && countOpenNeighbours(i, j) != 2)
+			{
+				vertexIndex[i * ySize + j] = vertexCells.size();
+				vertexCells.push_back(i * ySize + j);
+			}
+		}
+	}
+	for (std::pair<int, int> cell : extraVertices) // e.g. the start and goal, so the search can begin and end on them
+	{
+		if (!maze->isPassable(cell.first, cell.second) || vertexIndex[cell.first * ySize + cell.second] != -1) continue;
+		vertexIndex[cell.first * ySize + cell.second] = vertexCells.size();
+		vertexCells.push_back(cell.first * ySize + cell.second);
+	}
+	for (int vertex = 0; vertex < (int)vertexCells.size(); vertex++) // Walk each corridor leaving each vertex until it reaches another vertex
+	{
+		edgeStart.push_back(edges.size());
+		int vertexX = vertexCells[vertex] / ySize;
+		int vertexY = vertexCells[vertex] % ySize;
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int x = vertexX + xOffsets[direction];
+			int y = vertexY + yOffsets[direction];
+			if (!maze->isPassable(x, y)) continue;
+			int cameFrom = (direction + 2) % 4;
+			int length = 1;
+			while (vertexIndex[x * ySize + y] == -1)
+			{
+				for (int next = 0; next < 4; next++)
+				{
+					if (next == cameFrom || !maze->isPassable(x + xOffsets[next], y + yOffsets[next])) continue;
+					x += xOffsets[next];
+					y += yOffsets[next];
+					cameFrom = (next + 2) % 4;
+					break;
+				}
+				length++;
+			}
+			if (vertexIndex[x * ySize + y] == vertex) continue; // A loop straight back to where it started is never on a shortest path
+			edges.push_back(Edge{ vertexIndex[x * ySize + y], length, direction });
+		}
+	}
+	edgeStart.push_back(edges.size());
+}
+
+int JunctionGraph::countOpenNeighbours(int x, int y)
+{
+	return parentMaze->isPassable(x - 1, y) + parentMaze->isPassable(x + 1, y) + parentMaze->isPassable(x, y - 1) + parentMaze->isPassable(x, y + 1);
+}
+
+int JunctionGraph::getVertexCount(void)
+{
+	return (int)this->vertexCells.size();
+}
+
+int JunctionGraph::getEdgeCount(void)
+{
+	return (int)this->edges.size();
+}
+
+int JunctionGraph::getVertex(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= parentMaze->getXSize() || y >= parentMaze->getYSize()) return -1;
+	return this->vertexIndex[x * parentMaze->getYSize() + y];
+}
+
+int JunctionGraph::getCell(int vertex)
+{
+	return this->vertexCells[vertex];
+}
+
+JunctionGraph::Edge* JunctionGraph::edgesBegin(int vertex)
+{
+	return this->edges.data() + this->edgeStart[vertex];
+}
+
+JunctionGraph::Edge* JunctionGraph::edgesEnd(int vertex)
+{
+	return this->edges.data() + this->edgeStart[vertex + 1];
+}
+
+void JunctionGraph::appendCorridor(int vertex, Edge& edge, std::vector<int>& path) // Re-walks the corridor rather than storing every cell of every edge
+{
+	int ySize = parentMaze->getYSize();
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int x = vertexCells[vertex] / ySize + xOffsets[edge.direction];
+	int y = vertexCells[vertex] % ySize + yOffsets[edge.direction];
+	int cameFrom = (edge.direction + 2) % 4;
+	path.push_back(x * ySize + y);
+	while (vertexIndex[x * ySize + y] == -1)
+	{
+		for (int next = 0; next < 4; next++)
+		{
+			if (next == cameFrom || !parentMaze->isPassable(x + xOffsets[next], y + yOffsets[next])) continue;
+			x += xOffsets[next];
+			y += yOffsets[next];
+			cameFrom = (next + 2) % 4;
+			break;
+		}
+		path.push_back(x * ySize + y);
+	}
+}
+
+ContractedAStar::ContractedAStar(Maze* maze) : PathSolver(maze), graph(maze, getRouteEnds(maze))
+{
+	std::cout << "Contracted " << maze->getXSize() * maze->getYSize() << " cells into " << graph.getVertexCount() << " junctions and " << graph.getEdgeCount() << " corridors" << std::endl;
+	findShortestPath();
+}
+
+void ContractedAStar::findShortestPath(void)
+{
+	int ySize = parentMaze->getYSize();
+	int startX = parentMaze->getStartX();
+	int startY = parentMaze->getStartY();
+	int startVertex = graph.getVertex(startX, startY);
+	int goalVertex = -1; // The graph kept every goal, so the first one popped is the nearest
+	if (startVertex == -1) return;
+	std::vector<int> distance(graph.getVertexCount(), INT_MAX);
+	std::vector<int> previousVertex(graph.getVertexCount(), -1);
+	std::vector<JunctionGraph::Edge*> previousEdge(graph.getVertexCount(), NULL);
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> openList; // (distance + heuristic, vertex)
+	distance[startVertex] = 0;
+	openList.push(std::make_pair(parentMaze->getGoalHeuristic(startX, startY), startVertex));
+	while (!openList.empty())
+	{
+		int vertex = openList.top().second;
+		int cell = graph.getCell(vertex);
+		int estimate = openList.top().first;
+		openList.pop();
+		if (estimate > distance[vertex] + parentMaze->getGoalHeuristic(cell / ySize, cell % ySize)) continue; // Stale entry
+		examinedNodes++;
+		if (parentMaze->isGoal(cell / ySize, cell % ySize))
+		{
+			goalVertex = vertex;
+			break;
+		}
+		for (JunctionGraph::Edge* edge = graph.edgesBegin(vertex); edge != graph.edgesEnd(vertex); edge++)
+		{
+			int newDistance = distance[vertex] + edge->length;
+			if (newDistance >= distance[edge->target]) continue;
+			int targetCell = graph.getCell(edge->target);
+			distance[edge->target] = newDistance;
+			previousVertex[edge->target] = vertex;
+			previousEdge[edge->target] = edge;
+			openList.push(std::make_pair(newDistance + parentMaze->getGoalHeuristic(targetCell / ySize, targetCell % ySize), edge->target));
+		}
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (goalVertex == -1) return;
+
+	std::vector<int> junctionRoute;
+	for (int vertex = goalVertex; vertex != -1; vertex = previousVertex[vertex]) junctionRoute.push_back(vertex);
+	std::vector<int> path(1, graph.getCell(startVertex));
+	for (int i = (int)junctionRoute.size() - 1; i > 0; i--)
+	{
+		graph.appendCorridor(junctionRoute[i], *previousEdge[junctionRoute[i - 1]], path);
+	}
+	setRoute(path);
+}
+
+DeadEndFiller::DeadEndFiller(Maze* maze, std::vector<std::pair<int, int>> keptCells) : mask(maze)
+{
+	int xSize = maze->getXSize();
+	int ySize = maze->getYSize();
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	std::vector<char> openNeighbours(xSize * ySize, 0);
+	std::vector<bool> kept(xSize * ySize, false);
+	std::vector<int> worklist;
+	filledCells = 0;
+	for (std::pair<int, int> cell : keptCells)
+	{
+		if (cell.first >= 0 && cell.second >= 0 && cell.first < xSize && cell.second < ySize) kept[cell.first * ySize + cell.second] = true;
+	}
+	for (int i = 0; i < xSize; i++) // Every cell with one or no way out is a dead end to start from
+	{
+		for (int j = 0; j < ySize; j++)
+		{
+			if (!mask.get(i, j)) continue;
+			openNeighbours[i * ySize + j] = mask.get(i - 1, j) + mask.get(i + 1, j) + mask.get(i, j - 1) + mask.get(i, j + 1);
+			if (openNeighbours[i * ySize + j] <= 1 && !kept[i * ySize + j]) worklist.push_back(i * ySize + j);
+		}
+	}
+	while (!worklist.empty()) // Filling a dead end can turn the cell before it into a new dead end, so keep going until none are left
+	{
+		int index = worklist.back();
+		worklist.pop_back();
+		int x = index / ySize;
+		int y = index % ySize;
+		mask.set(x, y, false);
+		filledCells++;
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int neighbourX = x + xOffsets[direction];
+			int neighbourY = y + yOffsets[direction];
+			if (!mask.get(neighbourX, neighbourY)) continue;
+			int neighbourIndex = neighbourX * ySize + neighbourY;
+			if (--openNeighbours[neighbourIndex] == 1 && !kept[neighbourIndex]) worklist.push_back(neighbourIndex);
+		}
+	}
+}
+
+PassabilityMap* DeadEndFiller::getMask(void)
+{
+	return &this->mask;
+}
+
+int DeadEndFiller::getFilledCells(void)
+{
+	return this->filledCells;
+}
+
+DeadEndFilling::DeadEndFilling(Maze* maze) : PathSolver(maze), filler(maze, getRouteEnds(maze))
+{
+	std::cout << "Filled " << filler.getFilledCells() << " dead-end cells" << std::endl;
+	findShortestPath();
+}
+
+void DeadEndFilling::findShortestPath(void)
+{
+	PassabilityMap* mask = filler.getMask();
+	int xSize = parentMaze->getXSize();
+	int ySize = parentMaze->getYSize();
+	int startX = parentMaze->getStartX();
+	int startY = parentMaze->getStartY();
+	int goalIndex = -1;
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	if (!mask->get(startX, startY)) return;
+	std::vector<int> previous(xSize * ySize, -1);
+	std::vector<bool> visited(xSize * ySize, false);
+	std::queue<int> frontier;
+	frontier.push(startX * ySize + startY);
+	visited[startX * ySize + startY] = true;
+	while (!frontier.empty())
+	{
+		int index = frontier.front();
+		frontier.pop();
+		examinedNodes++;
+		if (parentMaze->isGoal(index / ySize, index % ySize)) // The filler kept every goal, and the first one out of the queue is the nearest
+		{
+			goalIndex = index;
+			break;
+		}
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int neighbourX = index / ySize + xOffsets[direction];
+			int neighbourY = index % ySize + yOffsets[direction];
+			if (!mask->get(neighbourX, neighbourY) || visited[neighbourX * ySize + neighbourY]) continue;
+			visited[neighbourX * ySize + neighbourY] = true;
+			previous[neighbourX * ySize + neighbourY] = index;
+			frontier.push(neighbourX * ySize + neighbourY);
+		}
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (goalIndex == -1) return;
+	std::vector<int> path;
+	for (int index = goalIndex; index != -1; index = previous[index]) path.push_back(index);
+	std::reverse(path.begin(), path.end());
+	setRoute(path);
+}
+
+DistanceFieldSolver::DistanceFieldSolver(Maze* maze)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	maze->getGoalDistances(); // Build the field now so the first move doesn't pay for it
+}
+
+void DistanceFieldSolver::MoveToNext(void) // Any neighbour one step closer to the goal is on a shortest route from here
+{
+	int x = parentCar->GetX();
+	int y = parentCar->GetY();
+	int distance = parentMaze->getGoalDistance(x, y);
+	if (distance <= 0) return; // Already at the goal, or the goal can't be reached from here
+	std::vector<uint16_t>* goalDistances = parentMaze->getGoalDistances();
+	for (int neighbourIndex : parentMaze->getOpenNeighbours(x, y))
+	{
+		if ((*goalDistances)[neighbourIndex] == distance - 1)
+		{
+			parentCar->SetPos(neighbourIndex / parentMaze->getYSize(), neighbourIndex % parentMaze->getYSize());
+			return;
+		}
+	}
+}
+
+static const int UNREACHABLE = INT_MAX / 2; // Leaves room to add a step or a heuristic without overflowing
+
+DStarLite::DStarLite(Maze* maze)
+{
+	this->parentMaze = maze;
+	this->parentCar = maze->GetCar();
+	this->xSize = maze->getXSize();
+	this->ySize = maze->getYSize();
+	this->startIndex = maze->getStartX() * ySize + maze->getStartY(); // After this it follows the car
+	this->lastStartIndex = startIndex;
+	this->keyModifier = 0;
+	this->examinedNodes = 0;
+	this->replanNeeded = false;
+	this->g = std::vector<int>(xSize * ySize, UNREACHABLE);
+	this->rhs = std::vector<int>(xSize * ySize, UNREACHABLE);
+	this->inQueue = std::vector<bool>(xSize * ySize, false);
+	this->queuedKey = std::vector<std::pair<int, int>>(xSize * ySize);
+	for (int goalIndex : maze->getGoalIndices()) // Every goal is a zero-cost root, so g ends up as the distance to the nearest
+	{
+		rhs[goalIndex] = 0;
+		queueVertex(goalIndex);
+	}
+	computeShortestPath();
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	maze->addListener(this);
+}
+
+DStarLite::~DStarLite(void)
+{
+	parentMaze->removeListener(this);
+}
+
+int DStarLite::heuristic(int from, int to)
+{
+	return abs(from / ySize - to / ySize) + abs(from % ySize - to % ySize);
+}
+
+std::pair<int, int> DStarLite::calculateKey(int index)
+{
+	int best = std::min(g[index], rhs[index]);
+	return std::make_pair(std::min(best + heuristic(startIndex, index) + keyModifier, UNREACHABLE), best);
+}
+
+void DStarLite::queueVertex(int index)
+{
+	inQueue[index] = true;
+	queuedKey[index] = calculateKey(index);
+	openList.push(std::make_pair(queuedKey[index], index));
+}
+
+void DStarLite::updateVertex(int index) // Recalculate rhs from the neighbours, and (re)queue the vertex if that leaves it inconsistent
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	int x = index / ySize;
+	int y = index % ySize;
+	if (!parentMaze->isPassable(x, y)) rhs[index] = UNREACHABLE;
+	else if (parentMaze->isGoal(x, y)) rhs[index] = 0;
+	else
+	{
+		rhs[index] = UNREACHABLE;
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int neighbourX = x + xOffsets[direction];
+			int neighbourY = y + yOffsets[direction];
+			if (!parentMaze->isPassable(neighbourX, neighbourY)) continue;
+			rhs[index] = std::min(rhs[index], g[neighbourX * ySize + neighbourY] + 1);
+		}
+		rhs[index] = std::min(rhs[index], UNREACHABLE);
+	}
+	inQueue[index] = false; // Any entry already in the heap is now stale
+	if (g[index] != rhs[index]) queueVertex(index);
+}
+
+void DStarLite::computeShortestPath(void)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	while (!openList.empty())
+	{
+		std::pair<int, int> topKey = openList.top().first;
+		int index = openList.top().second;
+		if (!inQueue[index] || queuedKey[index] != topKey) // Skip entries that were superseded or removed
+		{
+			openList.pop();
+			continue;
+		}
+		if (!(topKey < calculateKey(startIndex)) && rhs[startIndex] == g[startIndex]) break;
+		openList.pop();
+		inQueue[index] = false;
+		examinedNodes++;
+		std::pair<int, int> newKey = calculateKey(index);
+		if (topKey < newKey) // Its key went up since it was queued (the car moved), so it just goes back in
+		{
+			queueVertex(index);
+			continue;
+		}
+		if (g[index] > rhs[index]) g[index] = rhs[index]; // Overconsistent, the new value is final
+		else // Underconsistent, something it relied on got worse. Reset it and let its neighbours rebuild it.
+		{
+			g[index] = UNREACHABLE;
+			updateVertex(index);
+		}
+		for (int direction = 0; direction < 4; direction++)
+		{
+			int neighbourX = index / ySize + xOffsets[direction];
+			int neighbourY = index % ySize + yOffsets[direction];
+			if (neighbourX < 0 || neighbourY < 0 || neighbourX >= xSize || neighbourY >= ySize) continue;
+			updateVertex(neighbourX * ySize + neighbourY);
+		}
+	}
+}
+
+void DStarLite::spaceChanged(int x, int y) // Only the changed space and the four spaces next to it need their rhs re-checked
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	keyModifier += heuristic(lastStartIndex, startIndex);
+	lastStartIndex = startIndex;
+	updateVertex(x * ySize + y);
+	for (int direction = 0; direction < 4; direction++)
+	{
+		int neighbourX = x + xOffsets[direction];
+		int neighbourY = y + yOffsets[direction];
+		if (neighbourX < 0 || neighbourY < 0 || neighbourX >= xSize || neighbourY >= ySize) continue;
+		updateVertex(neighbourX * ySize + neighbourY);
+	}
+	replanNeeded = true;
+}
+
+void DStarLite::MoveToNext(void)
+{
+	const int xOffsets[4] = { -1, 0, 1, 0 };
+	const int yOffsets[4] = { 0, -1, 0, 1 };
+	startIndex = parentCar->GetX() * ySize + parentCar->GetY();
+	if (replanNeeded)
+	{
+		computeShortestPath();
+		replanNeeded = false;
+	}
+	if (parentMaze->isGoal(parentCar->GetX(), parentCar->GetY()) || rhs[startIndex] >= UNREACHABLE) return; // At a goal, or walled off from them all
+	int bestIndex = -1;
+	for (int direction = 0; direction < 4; direction++)
+	{
+		int neighbourX = parentCar->GetX() + xOffsets[direction];
+		int neighbourY = parentCar->GetY() + yOffsets[direction];
+		if (!parentMaze->isPassable(neighbourX, neighbourY)) continue;
+		if (bestIndex == -1 || g[neighbourX * ySize + neighbourY] < g[bestIndex]) bestIndex = neighbourX * ySize + neighbourY;
+	}
+	if (bestIndex == -1) return;
+	parentCar->SetPos(bestIndex / ySize, bestIndex % ySize);
+	startIndex = bestIndex;
+}
+
+int DStarLite::getExaminedNodes(void)
+{
+	return this->examinedNodes;
+}
+
+HierarchicalAStar::HierarchicalAStar(Maze* maze, int clusterSize) : PathSolver(maze)
+{
+	this->clusterSize = clusterSize;
+	this->clustersX = (maze->getXSize() + clusterSize - 1) / clusterSize;
+	this->clustersY = (maze->getYSize() + clusterSize - 1) / clusterSize;
+	this->replanNeeded = false;
+	this->rebuildCount = 0;
+	for (int i = 0; i < clustersX; i++)
+	{
+		for (int j = 0; j < clustersY; j++)
+		{
+			Cluster cluster;
+			cluster.x1 = i * clusterSize;
+			cluster.y1 = j * clusterSize;
+			cluster.x2 = std::min(cluster.x1 + clusterSize, maze->getXSize()) - 1;
+			cluster.y2 = std::min(cluster.y1 + clusterSize, maze->getYSize()) - 1;
+			cluster.dirty = true;
+			clusters.push_back(cluster);
+		}
+	}
+	findPath(maze->getStartX(), maze->getStartY());
+	maze->addListener(this);
+}
+
+HierarchicalAStar::~HierarchicalAStar(void)
+{
+	parentMaze->removeListener(this);
+}
+
+int HierarchicalAStar::getClusterOf(int x, int y)
+{
+	return (x / clusterSize) * clustersY + y / clusterSize;
+}
+
+int HierarchicalAStar::getLocalIndex(Cluster& cluster, int cell)
+{
+	int ySize = parentMaze->getYSize();
+	return (cell / ySize - cluster.x1) * (cluster.y2 - cluster.y1 + 1) + cell % ySize - cluster.y1;
+}
+
+// Walks one border of a cluster (length cells from (x, y) in steps of (runX, runY)) looking for runs where both this side and the
+// other side are open. Short runs get one entrance in the middle, longer ones get one at each end, as in the HPA* paper.
+void HierarchicalAStar::addBorderEntrances(Cluster& cluster, int x, int y, int runX, int runY, int length, int outsideX, int outsideY)
+{
+	int ySize = parentMaze->getYSize();
+	int runStart = -1;
+	for (int t = 0; t <= length; t++)
+	{
+		int insideX = x + t * runX, insideY = y + t * runY;
+		bool open = t < length && parentMaze->isPassable(insideX, insideY) && parentMaze->isPassable(insideX + outsideX, insideY + outsideY);
+		if (open && runStart == -1) runStart = t;
+		if (open || runStart == -1) continue;
+		int runLength = t - runStart;
+		std::vector<int> picks;
+		if (runLength < 6) picks.push_back(runStart + runLength / 2);
+		else
+		{
+			picks.push_back(runStart);
+			picks.push_back(t - 1);
+		}
+		for (int pick : picks)
+		{
+			int pickX = x + pick * runX, pickY = y + pick * runY;
+			cluster.entrances.push_back(pickX * ySize + pickY);
+			cluster.partners.push_back((pickX + outsideX) * ySize + pickY + outsideY);
+		}
+		runStart = -1;
+	}
+}
+
+void HierarchicalAStar::rebuildCluster(int clusterIndex)
+{
+	Cluster& cluster = clusters[clusterIndex];
+	int width = cluster.x2 - cluster.x1 + 1;
+	int height = cluster.y2 - cluster.y1 + 1;
+	cluster.entrances.clear();
+	cluster.partners.clear();
+	addBorderEntrances(cluster, cluster.x1, cluster.y1, 0, 1, height, -1, 0); // Borders off the edge of the maze find nothing, since isPassable is false there
+	addBorderEntrances(cluster, cluster.x2, cluster.y1, 0, 1, height, 1, 0);
+	addBorderEntrances(cluster, cluster.x1, cluster.y1, 1, 0, width, 0, -1);
+	addBorderEntrances(cluster, cluster.x1, cluster.y2, 1, 0, width, 0, 1);
+	int count = (int)cluster.entrances.size();
+	cluster.distances.assign(count * count, -1);
+	std::vector<int> distances, previous;
+	for (int i = 0; i < count; i++)
+	{
+		searchCluster(clusterIndex, { cluster.entrances[i] }, distances, previous);
+		for (int j = 0; j < count; j++)
+		{
+			cluster.distances[i * count + j] = distances[getLocalIndex(cluster, cluster.entrances[j])];
+		}
+	}
+	cluster.dirty = false;
+	rebuildCount++;
+}
+
+void HierarchicalAStar::searchCluster(int clusterIndex, const std::vector<int>& fromCells, std::vector<int>& distances, std::vector<int>& previous)
+{
+	Cluster& cluster = clusters[clusterIndex];
+	int ySize = parentMaze->getYSize();
+	int height = cluster.y2 - cluster.y1 + 1;
+	distances.assign((cluster.x2 - cluster.x1 + 1) * height, -1);
+	previous.assign(distances.size(), -1);
+	std::vector<int> frontier = fromCells;
+	for (int fromCell : fromCells) distances[getLocalIndex(cluster, fromCell)] = 0;
+	for (size_t next = 0; next < frontier.size(); next++)
+	{
+		int cell = frontier[next];
+		for (int neighbour : parentMaze->getOpenNeighbours(cell / ySize, cell % ySize))
+		{
+			int x = neighbour / ySize, y = neighbour % ySize;
+			if (x < cluster.x1 || x > cluster.x2 || y < cluster.y1 || y > cluster.y2) continue;
+			int local = getLocalIndex(cluster, neighbour);
+			if (distances[local] != -1) continue;
+			distances[local] = distances[getLocalIndex(cluster, cell)] + 1;
+			previous[local] = cell;
+			frontier.push_back(neighbour);
+		}
+	}
+}
+
+void HierarchicalAStar::findPath(int startX, int startY)
+{
+	int ySize = parentMaze->getYSize();
+	int startCell = startX * ySize + startY;
+	int goalNode = parentMaze->getXSize() * ySize; // Not a cell: every goal links to it, so the abstract search aims at all of them at once
+	std::vector<int> path(1, startCell);
+	setRoute(path); // Clear the old route first, in case there's no way through any more
+	if (!parentMaze->isPassable(startX, startY) || parentMaze->isGoal(startX, startY)) return;
+	for (int i = 0; i < (int)clusters.size(); i++)
+	{
+		if (clusters[i].dirty) rebuildCluster(i);
+	}
+	std::unordered_map<int, std::vector<int>> goalsByCluster;
+	for (int goalIndex : parentMaze->getGoalIndices()) goalsByCluster[getClusterOf(goalIndex / ySize, goalIndex % ySize)].push_back(goalIndex);
+	if (goalsByCluster.empty()) return;
+	std::unordered_map<int, std::vector<int>> goalDistances, goalPrevious; // Temporary edges to the goals, one search per cluster holding any
+	for (std::pair<const int, std::vector<int>>& entry : goalsByCluster) searchCluster(entry.first, entry.second, goalDistances[entry.first], goalPrevious[entry.first]);
+	int startCluster = getClusterOf(startX, startY);
+	std::vector<int> startDistances, previous;
+	searchCluster(startCluster, { startCell }, startDistances, previous); // ...and from the start
+
+	std::unordered_map<int, int> distance;
+	std::unordered_map<int, int> previousNode;
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> openList; // (distance + heuristic, cell)
+	std::vector<std::pair<int, int>> edges;
+	distance[startCell] = 0;
+	openList.push(std::make_pair(parentMaze->getGoalHeuristic(startX, startY), startCell));
+	while (!openList.empty())
+	{
+		int cell = openList.top().second;
+		int estimate = openList.top().first;
+		openList.pop();
+		if (cell == goalNode) break; // The heuristic is 0 there, so the first pop is the cheapest
+		int x = cell / ySize, y = cell % ySize;
+		if (estimate > distance[cell] + parentMaze->getGoalHeuristic(x, y)) continue; // Stale entry
+		examinedNodes++;
+		edges.clear();
+		int clusterIndex = getClusterOf(x, y);
+		Cluster& cluster = clusters[clusterIndex];
+		if (cell == startCell)
+		{
+			for (int entrance : cluster.entrances)
+			{
+				if (startDistances[getLocalIndex(cluster, entrance)] >= 0) edges.push_back(std::make_pair(entrance, startDistances[getLocalIndex(cluster, entrance)]));
+			}
+		}
+		int count = (int)cluster.entrances.size();
+		for (int i = 0; i < count; i++)
+		{
+			if (cluster.entrances[i] != cell) continue;
+			edges.push_back(std::make_pair(cluster.partners[i], 1));
+			for (int j = 0; j < count; j++)
+			{
+				if (cluster.distances[i * count + j] > 0) edges.push_back(std::make_pair(cluster.entrances[j], cluster.distances[i * count + j]));
+			}
+		}
+		std::unordered_map<int, std::vector<int>>::iterator toGoal = goalDistances.find(clusterIndex);
+		if (toGoal != goalDistances.end() && toGoal->second[getLocalIndex(cluster, cell)] >= 0) edges.push_back(std::make_pair(goalNode, toGoal->second[getLocalIndex(cluster, cell)]));
+		for (std::pair<int, int> edge : edges)
+		{
+			int newDistance = distance[cell] + edge.second;
+			std::unordered_map<int, int>::iterator known = distance.find(edge.first);
+			if (known != distance.end() && known->second <= newDistance) continue;
+			distance[edge.first] = newDistance;
+			previousNode[edge.first] = cell;
+			int heuristic = (edge.first == goalNode) ? 0 : parentMaze->getGoalHeuristic(edge.first / ySize, edge.first % ySize);
+			openList.push(std::make_pair(newDistance + heuristic, edge.first));
+		}
+	}
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	if (distance.find(goalNode) == distance.end()) return;
+
+	std::vector<int> abstractPath; // Refine: crossings are single steps, everything else is a search inside one cluster
+	for (int cell = previousNode[goalNode]; cell != startCell; cell = previousNode[cell]) abstractPath.push_back(cell);
+	abstractPath.push_back(startCell);
+	std::reverse(abstractPath.begin(), abstractPath.end());
+	std::vector<int> distances, segment;
+	for (size_t i = 1; i < abstractPath.size(); i++)
+	{
+		int from = abstractPath[i - 1], to = abstractPath[i];
+		int clusterIndex = getClusterOf(from / ySize, from % ySize);
+		if (clusterIndex != getClusterOf(to / ySize, to % ySize))
+		{
+			path.push_back(to);
+			continue;
+		}
+		searchCluster(clusterIndex, { from }, distances, previous);
+		segment.clear();
+		for (int cell = to; cell != from; cell = previous[getLocalIndex(clusters[clusterIndex], cell)]) segment.push_back(cell);
+		path.insert(path.end(), segment.rbegin(), segment.rend());
+	}
+	int last = abstractPath.back(); // The goal search already points the rest of the way, to whichever goal is closest inside the cluster
+	int lastCluster = getClusterOf(last / ySize, last % ySize);
+	for (int cell = goalPrevious[lastCluster][getLocalIndex(clusters[lastCluster], last)]; cell != -1; cell = goalPrevious[lastCluster][getLocalIndex(clusters[lastCluster], cell)]) path.push_back(cell);
+	setRoute(path);
+}
+
+void HierarchicalAStar::spaceChanged(int x, int y)
+{
+	int clusterX = x / clusterSize, clusterY = y / clusterSize;
+	clusters[getClusterOf(x, y)].dirty = true;
+	if (x % clusterSize == 0 && clusterX > 0) clusters[getClusterOf(x - 1, y)].dirty = true; // Entrances depend on the cells on both sides of a border
+	if ((x + 1) % clusterSize == 0 && clusterX + 1 < clustersX) clusters[getClusterOf(x + 1, y)].dirty = true;
+	if (y % clusterSize == 0 && clusterY > 0) clusters[getClusterOf(x, y - 1)].dirty = true;
+	if ((y + 1) % clusterSize == 0 && clusterY + 1 < clustersY) clusters[getClusterOf(x, y + 1)].dirty = true;
+	replanNeeded = true;
+}
+
+void HierarchicalAStar::MoveToNext(void)
+{
+	if (replanNeeded)
+	{
+		replanNeeded = false;
+		findPath(parentCar->GetX(), parentCar->GetY());
+	}
+	PathSolver::MoveToNext();
+}
+
+int HierarchicalAStar::getClusterRebuildCount(void)
+{
+	return this->rebuildCount;
+}
+
+TreeDistanceIndex::TreeDistanceIndex(Maze* maze)
+{
+	int xSize = maze->getXSize();
+	this->ySize = maze->getYSize();
+	this->extraEdges = 0;
+	parent.assign(xSize * ySize, -1);
+	depth.assign(xSize * ySize, -1);
+	component.assign(xSize * ySize, -1);
+	firstVisit.assign(xSize * ySize, -1);
+	eulerCells.reserve(2 * xSize * ySize);
+	int components = 0;
+	std::vector<std::pair<int, int>> stack; // (cell, number of its neighbours already tried)
+	for (int root = 0; root < xSize * ySize; root++)
+	{
+		if (component[root] != -1 || !maze->isPassable(root / ySize, root % ySize)) continue;
+		component[root] = components;
+		depth[root] = 0;
+		firstVisit[root] = (int)eulerCells.size();
+		eulerCells.push_back(root);
+		stack.push_back(std::make_pair(root, 0));
+		while (!stack.empty())
+		{
+			int cell = stack.back().first;
+			NeighbourList neighbours = maze->getOpenNeighbours(cell / ySize, cell % ySize);
+			if (stack.back().second == neighbours.size())
+			{
+				stack.pop_back();
+				if (!stack.empty()) eulerCells.push_back(stack.back().first); // Back up to the parent
+				continue;
+			}
+			int neighbour = neighbours[stack.back().second++];
+			if (neighbour == parent[cell]) continue;
+			if (component[neighbour] != -1)
+			{
+				if (depth[neighbour] < depth[cell]) extraEdges++; // Counts each loop-closing edge once, from its deeper end
+				continue;
+			}
+			component[neighbour] = components;
+			parent[neighbour] = cell;
+			depth[neighbour] = depth[cell] + 1;
+			firstVisit[neighbour] = (int)eulerCells.size();
+			eulerCells.push_back(neighbour);
+			stack.push_back(std::make_pair(neighbour, 0));
+		}
+		components++;
+	}
+	eulerDepths.resize(eulerCells.size());
+	for (size_t i = 0; i < eulerCells.size(); i++) eulerDepths[i] = depth[eulerCells[i]];
+
+	// Sparse table over block minima rather than every tour position, so memory stays linear for big mazes. A query scans at most
+	// two partial blocks, which keeps it constant time.
+	int blocks = ((int)eulerCells.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	blockTable.push_back(std::vector<int>(blocks));
+	for (int b = 0; b < blocks; b++)
+	{
+		blockTable[0][b] = scanRange(b * BLOCK_SIZE, std::min((b + 1) * BLOCK_SIZE, (int)eulerCells.size()) - 1);
+	}
+	for (int k = 1; (1 << k) <= blocks; k++)
+	{
+		std::vector<int>& previousLevel = blockTable[k - 1];
+		std::vector<int> level(blocks - (1 << k) + 1);
+		for (size_t b = 0; b < level.size(); b++) level[b] = shallowerOf(previousLevel[b], previousLevel[b + (1 << (k - 1))]);
+		blockTable.push_back(level);
+	}
+}
+
+int TreeDistanceIndex::shallowerOf(int a, int b)
+{
+	return eulerDepths[b] < eulerDepths[a] ? b : a;
+}
+
+int TreeDistanceIndex::scanRange(int from, int to)
+{
+	int best = from;
+	for (int i = from + 1; i <= to; i++) best = shallowerOf(best, i);
+	return best;
+}
+
+bool TreeDistanceIndex::isPerfect(void)
+{
+	return extraEdges == 0;
+}
+
+int TreeDistanceIndex::getLowestCommonAncestor(int cellA, int cellB)
+{
+	if (component[cellA] == -1 || component[cellA] != component[cellB]) return -1;
+	int from = std::min(firstVisit[cellA], firstVisit[cellB]);
+	int to = std::max(firstVisit[cellA], firstVisit[cellB]);
+	int fromBlock = from / BLOCK_SIZE;
+	int toBlock = to / BLOCK_SIZE;
+	if (fromBlock == toBlock) return eulerCells[scanRange(from, to)];
+	int best = shallowerOf(scanRange(from, (fromBlock + 1) * BLOCK_SIZE - 1), scanRange(toBlock * BLOCK_SIZE, to));
+	if (toBlock - fromBlock > 1)
+	{
+		int k = 0;
+		while ((2 << k) <= toBlock - fromBlock - 1) k++;
+		best = shallowerOf(best, shallowerOf(blockTable[k][fromBlock + 1], blockTable[k][toBlock - (1 << k)]));
+	}
+	return eulerCells[best];
+}
+
+int TreeDistanceIndex::getDistance(int startX, int startY, int goalX, int goalY)
+{
+	int start = startX * ySize + startY;
+	int goal = goalX * ySize + goalY;
+	int ancestor = getLowestCommonAncestor(start, goal);
+	if (ancestor == -1) return -1;
+	return depth[start] + depth[goal] - 2 * depth[ancestor];
+}
+
+std::vector<int> TreeDistanceIndex::getPath(int startX, int startY, int goalX, int goalY)
+{
+	int start = startX * ySize + startY;
+	int goal = goalX * ySize + goalY;
+	std::vector<int> path;
+	int ancestor = getLowestCommonAncestor(start, goal);
+	if (ancestor == -1) return path;
+	for (int cell = start; cell != ancestor; cell = parent[cell]) path.push_back(cell);
+	size_t upLength = path.size();
+	for (int cell = goal; cell != ancestor; cell = parent[cell]) path.push_back(cell);
+	path.push_back(ancestor);
+	std::reverse(path.begin() + upLength, path.end()); // The goal half was collected going up, so flip it to run down from the ancestor
+	return path;
+}
+
+TreePathSolver::TreePathSolver(Maze* maze, TreeDistanceIndex* index) : PathSolver(maze)
+{
+	this->ownsIndex = index == NULL;
+	this->index = ownsIndex ? new TreeDistanceIndex(maze) : index;
+	if (!this->index->isPerfect()) std::cout << "Maze has loops, the tree route may not be the shortest" << std::endl;
+	std::pair<int, int> goal = maze->getGoals()[0];
+	int bestDistance = -1;
+	for (std::pair<int, int> candidate : maze->getGoals()) // Tree distances are a couple of lookups each, so just try every goal
+	{
+		int distance = this->index->getDistance(maze->getStartX(), maze->getStartY(), candidate.first, candidate.second);
+		if (distance == -1 || (bestDistance != -1 && distance >= bestDistance)) continue;
+		goal = candidate;
+		bestDistance = distance;
+	}
+	std::vector<int> path = this->index->getPath(maze->getStartX(), maze->getStartY(), goal.first, goal.second);
+	examinedNodes = (int)path.size();
+	std::cout << "Found solution after examining " << examinedNodes << " nodes" << std::endl;
+	setRoute(path);
+}
+
+TreePathSolver::~TreePathSolver(void)
+{
+	if (ownsIndex) delete index;
+}
+
+Node::Node(int X, int Y, int weight, int cost)
+{
+	this->x = X;
+	this->y = Y;
+	this->distance = INT_MAX;
 	this->previousNode = NULL;
 	this->weight = weight;
+	this->cost = cost;
 }
 
 void Node::setDistance(int newDist)
@@ -736,6 +3904,11 @@ int Node::getWeight(void)
 	return this->weight;
 }
 
+int Node::getCost(void)
+{
+	return this->cost;
+}
+
 bool Space::GetPassable(void)
 {
 	return this->Passable;
@@ -746,21 +3919,51 @@ std::string Space::GetColour(void)
 	return this->Colour;
 }
 
+int Space::GetCost(void)
+{
+	return this->Cost;
+}
+
 Empty::Empty()
 {
 	this->Colour = "White";
 	this->Passable = true;
+	this->Cost = 1;
 }
 
 Wall::Wall()
 {
 	this->Colour = "Black";
 	this->Passable = false;
+	this->Cost = 1;
 }
 
 Goal::Goal()
 {
 	this->Colour = "Green";
 	this->Passable = true;
+	this->Cost = 1;
+}
+
+Mud::Mud()
+{
+	this->Colour = "Brown";
+	this->Passable = true;
+	this->Cost = 4;
+}
+
+Ramp::Ramp()
+{
+	this->Colour = "Orange";
+	this->Passable = true;
+	this->Cost = 2;
+}
+
+SlowZone::SlowZone(int cost)
+{
+	if (cost < 1) throw std::invalid_argument("Moving onto a space has to cost at least 1!");
+	this->Colour = "Grey";
+	this->Passable = true;
+	this->Cost = cost;
 }
 
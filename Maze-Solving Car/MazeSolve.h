@@ -1,12 +1,33 @@
 #pragma once
 #include <vector>
 #include <stack>
+#include <queue>
+#include <functional>
 #include <string>
 #include <stdio.h>
 #include <exception>
 #include <iostream>
 #include <random>
 #include <chrono> 
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <bitset>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 
 
@@ -15,16 +36,53 @@ namespace MazeSolve
 
 	class MazeGenerator;
 	class RecursiveSubdivider;
+	class TerrainSubdivider;
 	class MazeSolver;
 	class FloodFill;
-	class Cell;
+	template <int Width, int Height, int RefloodBudget> class FloodFillFixed;
 	class Dijkstra;
 	class AStar;
+	class PathSolver;
+	class BidirectionalBFS;
+	class PassabilityMap;
+	class JumpPointSearch;
+	class JunctionGraph;
+	class ContractedAStar;
+	class DeadEndFiller;
+	class DeadEndFilling;
+	class DistanceFieldSolver;
+	class MazeListener;
+	class FastRandom;
+	class NeighbourList;
+	class WallSensor;
+	struct MotionModel;
+	class SpeedRunPlanner;
+	class ExploreThenSpeedRun;
+	class WallFollower;
+	class Pledge;
+	class Tremaux;
+	class DStarLite;
+	class HierarchicalAStar;
+	class TreeDistanceIndex;
+	class TreePathSolver;
+	class BitParallelBFS;
+	class ParallelBFS;
+	class DeltaStepping;
+	struct PortfolioEngine;
+	class PortfolioSolver;
+	class IDAStar;
+	class AnytimeAStar;
+	class SearchTask;
+	class SteppedSolver;
+	class SteppedAStar;
 	class Node;
 	class Space;
 	class Maze;
 	class Car;
 	class Empty;
+	class Mud;
+	class Ramp;
+	class SlowZone;
 
 	class MazeGenerator
 	{
@@ -60,6 +118,50 @@ namespace MazeSolve
 		void generateMaze(void);
 	};
 
+	class FastRandom // xorshift64* - much cheaper than constructing a std::random_device per call, and repeatable when given a seed
+	{
+	private:
+		uint64_t state;
+	public:
+		FastRandom(void); // Seeded from std::random_device
+		FastRandom(uint64_t seed); // Same seed, same sequence - use this for benchmarks
+		void setSeed(uint64_t seed);
+		uint32_t next(void);
+		int nextBelow(int bound);
+	};
+
+	class TerrainSubdivider : public RecursiveSubdivider // A RecursiveSubdivider maze with patches of mud, ramps and slow floor dropped onto its open spaces
+	{
+	private:
+		int patchCount;
+		FastRandom random;
+	public:
+		TerrainSubdivider(Maze* maze, int minSize = 2, int patchCount = -1); // -1 picks one patch per 64 spaces
+		void generateMaze(void);
+	};
+
+	class NeighbourList // Up to four open neighbours of a space as flat indices (x * ySize + y), stored inline so building one never allocates
+	{
+	private:
+		int cells[4];
+		int count;
+	public:
+		NeighbourList(void);
+		void add(int index);
+		int size(void);
+		int operator[](int i);
+		const int* begin(void);
+		const int* end(void);
+		void shuffle(FastRandom& random);
+	};
+
+	class MazeListener // Implement this and register with Maze::addListener to be told whenever SetSpace changes a space
+	{
+	public:
+		virtual ~MazeListener(void);
+		virtual void spaceChanged(int x, int y) = 0;
+	};
+
 	class MazeSolver
 	{
 	protected:
@@ -71,65 +173,642 @@ namespace MazeSolve
 		virtual void MoveToNext(void);
 	};
 
-	class FloodFill : public MazeSolver
+	class PathSolver : public MazeSolver // Base for solvers that plan the whole route up front and then just follow it
+	{
+	protected:
+		Maze* parentMaze;
+		std::stack<std::pair<int, int>> route;
+		int examinedNodes;
+		void setRoute(std::vector<int>& path); // Path is a list of flat indices (x * ySize + y) from the start to the goal
+	public:
+		PathSolver(Maze* maze);
+		void MoveToNext(void);
+		int getRouteLength(void);
+		int getExaminedNodes(void);
+	};
+
+	class FloodFill : public MazeSolver, public MazeListener
 	{
 	private:
-		std::vector<std::vector<Cell*>> floodMap;
-		std::vector<std::vector<Cell*>> generateFloodMap(void);
-		std::vector<Cell*> GetAdjacentCells(int x, int y);
+		int xSize;
+		int ySize;
+		std::vector<uint16_t> floodValues; // Flood value of each space (x * ySize + y), UNREACHABLE_FLOOD once it's known the goal can't be reached
+		std::vector<int> refloodQueue; // Ring buffer. The queued flags mean a space is never in it twice, so one slot per space is enough.
+		std::vector<bool> queued;
+		long long refloodCount;
+		long long refloodCellCount; // Spaces popped off the queue across all refloods
+		long long floodUpdateCount; // Flood values actually changed across all refloods
+		void generateFloodMap(void);
+		void reflood(int x, int y);
+		bool settleIfWalledOff(int x, int y); // Marks the whole component UNREACHABLE_FLOOD if no goal can be reached from it
+		bool spaceOpened; // Set when a space opens up, so anything settled as UNREACHABLE_FLOOD gets another chance
+		void reopenUnreachable(void);
+		uint16_t getLowestNeighbourValue(int x, int y);
+		FastRandom random;
+		PassabilityMap* knownMap; // Only used when exploring: what the car has seen so far, with unseen spaces assumed open
+		WallSensor* sensor;
+		long long moveCount;
+		std::chrono::nanoseconds moveTime; // Total time spent inside MoveToNext
+		bool isOpen(int x, int y); // Passability as far as the solver knows
+		NeighbourList GetAdjacentCells(int x, int y); // Shuffled, so ties are broken randomly
 
 	public:
-		FloodFill(Maze* maze);
+		static constexpr uint16_t UNREACHABLE_FLOOD = 0xFFFF;
+		FloodFill(Maze* maze, bool exploring = false); // When exploring, the car only learns about walls as it drives up to them
 		~FloodFill(void);
 		void MoveToNext();
+		void spaceChanged(int x, int y);
+		PassabilityMap* getKnownMap(void); // NULL unless exploring
+		WallSensor* getSensor(void); // NULL unless exploring
+		long long getMoveCount(void);
+		double getAverageMoveTime(void); // Seconds of compute per MoveToNext call
+		int GetFloodValue(int x, int y);
+		void setSeed(uint64_t seed); // Makes tie-breaking repeatable, for benchmarks
+		long long getRefloodCount(void);
+		long long getRefloodCellCount(void);
+		long long getFloodUpdateCount(void);
 	};
 
+	// Modified flood fill, shared by FloodFill and FloodFillFixed. A space is consistent when its value is one more than its lowest open
+	// neighbour. Each space popped off the ring buffer (head/size) that isn't gets raised to that, and since that can break its neighbours
+	// they get queued too. Values only ever go up, so it settles. Stops after budget pops so callers can bound the work per call.
+	// Returns the number of spaces popped, the reflood is finished once size is back to 0. Goals are the bottom and never raised.
+	template <typename FloodValues, typename Queue, typename QueuedFlags, typename GoalTest, typename OpenTest>
+	int runReflood(FloodValues& floodValues, Queue& queue, int& head, int& size, QueuedFlags& queued, int xSize, int ySize, GoalTest isGoal, int budget, OpenTest isOpen, long long& updateCount)
+	{
+		const int xOffsets[4] = { -1, 0, 1, 0 };
+		const int yOffsets[4] = { 0, -1, 0, 1 };
+		const int capacity = xSize * ySize;
+		int popped = 0;
+		while (size > 0 && popped < budget)
+		{
+			int index = queue[head];
+			head = (head + 1) % capacity;
+			size--;
+			queued[index] = false;
+			popped++;
+			int cellX = index / ySize;
+			int cellY = index % ySize;
+			uint16_t lowest = FloodFill::UNREACHABLE_FLOOD;
+			for (int direction = 0; direction < 4; direction++)
+			{
+				if (isOpen(cellX + xOffsets[direction], cellY + yOffsets[direction])) lowest = std::min(lowest, (uint16_t)floodValues[(cellX + xOffsets[direction]) * ySize + cellY + yOffsets[direction]]);
+			}
+			// No real distance reaches the number of spaces, so anything that climbs that far is walled off from every goal. Jumping
+			// straight to UNREACHABLE_FLOOD then lets the rest of its component settle instead of creeping up one value per pass.
+			uint16_t target = (lowest >= FloodFill::UNREACHABLE_FLOOD - 1 || lowest + 1 >= capacity) ? FloodFill::UNREACHABLE_FLOOD : lowest + 1;
+			if (isGoal(index) || floodValues[index] >= target) continue; // Already has a way downhill (or is the bottom)
+			floodValues[index] = target;
+			updateCount++;
+			for (int direction = 0; direction < 4; direction++)
+			{
+				int neighbourX = cellX + xOffsets[direction];
+				int neighbourY = cellY + yOffsets[direction];
+				if (!isOpen(neighbourX, neighbourY)) continue;
+				int neighbourIndex = neighbourX * ySize + neighbourY;
+				if (queued[neighbourIndex]) continue;
+				queued[neighbourIndex] = true;
+				queue[(head + size) % capacity] = (typename Queue::value_type)neighbourIndex;
+				size++;
+			}
+		}
+		return popped;
+	}
 
-	class Cell
+	class SearchTask // A search written as a coroutine. It starts suspended, and each resume runs it up to its next co_yield.
 	{
+	public:
+		struct promise_type
+		{
+			std::exception_ptr exception;
+			SearchTask get_return_object(void);
+			std::suspend_always initial_suspend(void) noexcept;
+			std::suspend_always final_suspend(void) noexcept;
+			std::suspend_always yield_value(int) noexcept; // Searches yield their examined count, but only the suspension is used
+			void return_void(void);
+			void unhandled_exception(void);
+		};
 	private:
-		int floodValue;
-		int x;
-		int y;
+		std::coroutine_handle<promise_type> handle;
 	public:
-		Cell(int value, int x, int y);
-		int GetFloodValue();
-		void incValue(int amount = 1);
-		void decValue(int amount = 1);
-		void setValue(int amount);
-		int getX(void);
-		int getY(void);
+		SearchTask(std::coroutine_handle<promise_type> handle);
+		SearchTask(SearchTask&& other) noexcept;
+		SearchTask(const SearchTask&) = delete;
+		SearchTask& operator=(const SearchTask&) = delete;
+		~SearchTask(void);
+		bool resume(void); // Returns false once the search has run to the end. Rethrows anything the search threw.
+		bool isDone(void);
 	};
 
+	// Base for path solvers whose search is a coroutine. Instead of doing it all in the constructor, each MoveToNext runs one slice,
+	// so the window keeps drawing and taking input while it works, and pausing the car pauses the search too. Solvers that take an
+	// expansionsPerSlice of 0 run the whole search from their constructor, as they did before they were ported.
+	class SteppedSolver : public PathSolver
+	{
+	public:
+		enum SearchMark { UNSEEN, FRONTIER, VISITED };
+	protected:
+		int expansionsPerSlice; // 0 never yields
+		std::vector<uint8_t> marks; // SearchMark of each space, so the search can be drawn while it runs
+		virtual SearchTask search(void) = 0; // Should co_yield every expansionsPerSlice expansions and call setRoute at the end
+		void restart(void); // Drops the current search and its marks, so the next slice starts search() again
+	private:
+		SearchTask* task; // Made on the first slice, as the derived class isn't built yet in this constructor
+		bool cancelled;
+	public:
+		SteppedSolver(Maze* maze, int expansionsPerSlice);
+		~SteppedSolver(void);
+		bool runSlice(void); // True while there's more searching to do
+		void finish(void); // Runs whatever's left of the search in one go
+		void cancel(void); // Abandons the search, the car stays where it is
+		bool isSearching(void);
+		bool isCancelled(void);
+		SearchMark getMark(int x, int y);
+		void MoveToNext(void); // Searches for a slice, then follows the route once there is one
+	};
 
-	class Dijkstra : public MazeSolver
+	class Dijkstra : public SteppedSolver
 	{
 	private:
 		std::vector <std::vector<Node*>> nodes;
+		bool eightConnected;
 		std::vector<Node*> unvisitedNodes;
-		std::stack<Node*> route;
-		Node* currentNode;
-		Node* goalNode;
-		void findShortestPath(void);
+		int searchX; // Where search() starts, the maze's start unless solveFrom moved it
+		int searchY;
+		SearchTask search(void);
 	public:
-		void MoveToNext(void);
-		Dijkstra(Maze* maze);
+		Dijkstra(Maze* maze, PassabilityMap* mask = NULL, int expansionsPerSlice = 0); // An optional mask (e.g. from DeadEndFiller) replaces the maze's own passability
 		Node* getClosestedUnvisitedNode(void);
+		void solveFrom(int x, int y); // Replans from another start on the node graph that's already built, for running many starts on one maze
 	};
 
-	class AStar : public MazeSolver
+	class AStar : public SteppedSolver
 	{
 	private:
 		std::vector <std::vector<Node*>> nodes;
+		bool eightConnected;
 		std::vector<Node*> unvisitedNodes;
-		std::stack<Node*> route;
-		Node* currentNode;
-		Node* goalNode;
+		int searchX;
+		int searchY;
+		SearchTask search(void);
+	public:
+		AStar(Maze* maze, PassabilityMap* mask = NULL, int expansionsPerSlice = 0);
+		Node* getClosestedUnvisitedNode(void);
+		void solveFrom(int x, int y); // Same as Dijkstra::solveFrom
+	};
+
+	class BidirectionalBFS : public SteppedSolver // Grows one BFS frontier from the start and one from the goal, a level at a time, until they meet
+	{
+	private:
+		SearchTask search(void);
+	public:
+		BidirectionalBFS(Maze* maze, int expansionsPerSlice = 0);
+	};
+
+	class PassabilityMap // Bit-packed copy of which spaces are passable. Each Y has its own row of 64-bit words with one bit per X, so runs along a row can be scanned a word at a time.
+	{
+	private:
+		int xSize;
+		int ySize;
+		int wordsPerRow;
+		std::vector<uint64_t> bits;
+	public:
+		PassabilityMap(Maze* maze);
+		PassabilityMap(int xSize, int ySize, bool passable); // Every space starts the same
+		bool get(int x, int y);
+		void set(int x, int y, bool passable);
+		uint64_t getWord(int word, int y); // Words outside the maze read as all walls
+		int getXSize(void);
+		int getYSize(void);
+		int getWordsPerRow(void);
+		NeighbourList getOpenNeighbours(int x, int y); // Same order as Maze::getOpenNeighbours
+	};
+
+	// Unit-cost BFS that moves a whole row of the frontier at once: shift it left, right, up and down, AND with the open spaces and
+	// AND-NOT with what's already been visited. Uses 256-bit AVX2 steps when the CPU has them and plain 64-bit words otherwise.
+	class BitParallelBFS : public SteppedSolver
+	{
+	private:
+		int xSize;
+		int ySize;
+		int wordsPerRow;
+		int stride; // Words per padded row: one zero word either side, rounded up so AVX2 can always load four words
+		std::vector<uint64_t> open; // ySize + 2 padded rows, the first and last are all walls
+		std::vector<uint64_t> visited;
+		std::vector<uint64_t> frontier;
+		std::vector<uint64_t> next;
+		std::vector<int> levels; // Flat cell index -> BFS level, -1 where the search didn't reach
+		bool useSimd;
+		int levelCount;
+		void expandRows(int firstRow, int lastRow); // Fills next for padded rows firstRow to lastRow
+		bool expandLevel(int& firstRow, int& lastRow, bool stopAtGoal, std::vector<int>* lastLevel); // One level, outside the coroutine so its locals stay in registers. True once it reaches a goal, lastRow is -1 if it reached nothing.
+		SearchTask searchLevels(int startX, int startY, bool stopAtGoal); // Yields between levels, once a slice's worth of spaces have been reached
+		SearchTask search(void);
+	public:
+		BitParallelBFS(Maze* maze, bool allowSimd = true, int expansionsPerSlice = 0);
+		void computeLevels(int startX, int startY, bool stopAtGoal = false); // Whole maze, or just up to the first level that reaches a goal. Not while a stepped search is still running.
+		int getLevel(int x, int y);
+		int getLevelCount(void); // Number of frontier expansions in the last search
+		bool isUsingSimd(void);
+		static bool cpuSupportsAvx2(void);
+	};
+
+	class ParallelBFS : public SteppedSolver // Level-synchronous BFS: each frontier is split across a pool of threads, which claim spaces with compare-and-swap on a shared parent array
+	{
+	private:
+		static const int CHUNK_SIZE = 256; // Frontier entries a thread claims at a time
+		static const int PARALLEL_THRESHOLD = 1024; // Smaller frontiers are expanded by the calling thread alone, waking the pool would cost more than it saves
+		int threadCount;
+		int parallelLevels;
+		SearchTask search(void); // Only yields between levels, with the pool parked on its barrier
+	public:
+		ParallelBFS(Maze* maze, int threadCount = 0, int expansionsPerSlice = 0); // 0 uses every hardware thread
+		int getThreadCount(void);
+		int getParallelLevelCount(void); // Levels that were big enough to hand to the pool
+	};
+
+	// Delta-stepping shortest paths over tile costs. Spaces are kept in buckets of width delta; each bucket's light moves (cost <= delta)
+	// are relaxed across a thread pool until the bucket stops changing, then its heavy moves are relaxed once.
+	class DeltaStepping : public PathSolver
+	{
+	private:
+		static const int CHUNK_SIZE = 256;
+		static const int PARALLEL_THRESHOLD = 1024; // Same idea as ParallelBFS, small phases stay on the calling thread
+		int delta;
+		int threadCount;
+		void findShortestPath(void);
+	public:
+		DeltaStepping(Maze* maze, int delta = 0, int threadCount = 0); // delta 0 picks half the dearest tile cost, threadCount 0 uses every hardware thread
+		int getDelta(void);
+		int getThreadCount(void);
+	};
+
+	struct PortfolioEngine
+	{
+		std::string name;
+		std::function<bool(Maze*, const std::atomic<bool>&, std::vector<int>&, int&)> run; // Fills in the route (start to goal inclusive) and how many nodes it examined. Should give up soon after the flag is set.
+	};
+
+	class PortfolioSolver : public PathSolver // Races several engines on their own threads, follows whichever finds a route first and cancels the rest
+	{
+	private:
+		std::string winner;
+		double winningTime; // Seconds
+		void race(std::vector<PortfolioEngine>& engines);
+	public:
+		PortfolioSolver(Maze* maze);
+		PortfolioSolver(Maze* maze, std::vector<PortfolioEngine> engines);
+		std::string getWinner(void); // Empty if nothing found a route
+		double getWinningTime(void);
+		static std::vector<PortfolioEngine> getDefaultEngines(Maze* maze); // Leaves out the unit-cost engines when the maze has terrain
+	};
+
+	// Iterative-deepening A*: depth-first searches under a cost bound that rises to the smallest f that went over it last time. Only
+	// the current path and a fixed-size transposition cache are stored, so memory doesn't grow with the maze. Without the cache, open
+	// rooms are hopeless, since every equal-cost way across them gets tried in turn.
+	class IDAStar : public PathSolver
+	{
+	private:
+		struct Frame
+		{
+			int index;
+			int distance; // Cost from the start
+			int neighbours[4]; // Nearest the goal first
+			int neighbourCount;
+			int nextNeighbour;
+		};
+		struct Transposition
+		{
+			int index;
+			int distance;
+			int iteration; // Entries from earlier iterations are ignored, so the cache never needs clearing
+		};
+		bool usePathBits;
+		std::vector<bool> onPathBits; // One bit per space, only with usePathBits
+		std::unordered_set<int> onPathSet; // Otherwise just the spaces on the current path
+		std::vector<Transposition> transpositions; // Direct-mapped and lossy, a collision just overwrites
+		int iterations;
+		bool isTransposition(int index, int distance); // True if this iteration already reached the space at least as cheaply, otherwise records it
+		int getHeuristic(int index);
+		Frame makeFrame(int index, int distance);
+		void setOnPath(int index, bool onPath);
+		bool isOnPath(int index);
+		void findShortestPath(void);
+	public:
+		IDAStar(Maze* maze, int transpositionEntries = 1 << 16, bool usePathBits = false); // Entries are rounded up to a power of two, 0 turns the cache off. Path bits make the cycle check a bit test instead of a hash lookup, for maze area / 8 bytes.
+		int getIterationCount(void);
+	};
+
+	// ARA*: weighted A* with an inflated heuristic gets a route out fast, then each frame spends a time budget lowering the inflation
+	// and repairing the search, reusing everything already expanded. It searches back from the goal, so the costs it has found stay
+	// true while the car drives and every new pass just aims at wherever the car has got to.
+	class AnytimeAStar : public MazeSolver
+	{
+	private:
+		enum SearchState { UNSEEN, OPEN, CLOSED, INCONSISTENT }; // INCONSISTENT spaces are closed but got cheaper since, they're reopened next pass
+		Maze* parentMaze;
+		std::chrono::microseconds frameBudget;
+		double epsilon;
+		double epsilonStep;
+		std::vector<int> distances; // Cost from each space to the goal, INT_MAX until reached
+		std::vector<int> parents; // Next space towards the goal
+		std::vector<uint8_t> states;
+		std::vector<int> inconsistent;
+		std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> openList; // Lazy, stale entries are skipped when popped
+		int targetIndex; // Where the car was when this pass started
+		int carIndex;
+		int examinedNodes;
+		bool passFinished;
+		bool routeFound;
+		bool optimal;
+		double getKey(int index);
+		void startPass(void);
+		bool improvePath(std::chrono::steady_clock::time_point deadline); // True once this pass is finished
+		void spendBudget(void);
+	public:
+		AnytimeAStar(Maze* maze, double frameBudgetMilliseconds = 2.0, double initialEpsilon = 3.0, double epsilonStep = 0.5);
+		void MoveToNext(void); // Improves the route for one frame's budget, then takes a step if there's a route yet
+		double getEpsilon(void); // The current route costs at most this times the best one
+		bool hasRoute(void);
+		bool isOptimal(void);
+		int getExaminedNodes(void);
+	};
+
+	class SteppedAStar : public SteppedSolver // A* (or Dijkstra without the heuristic) run a slice per frame, honours tile costs
+	{
+	private:
+		bool useHeuristic;
+		SearchTask search(void);
+	public:
+		SteppedAStar(Maze* maze, int expansionsPerSlice = 64, bool useHeuristic = true);
+	};
+
+	class WallSensor // Stands in for the car's distance sensors: it only reports the spaces directly next to the car
+	{
+	private:
+		Maze* parentMaze;
+		std::vector<bool> scanned; // Spaces the car has scanned from
+		std::vector<bool> observed; // Spaces the sensor has reported on, i.e. anything next to a scanned space
+		int cellsExplored;
+		int wallsFound;
+		long long scanCount;
+	public:
+		WallSensor(Maze* maze);
+		bool scan(int x, int y, PassabilityMap* knownMap); // Copies the walls around (x, y) into knownMap, returns true if any of them were new
+		bool hasObserved(int x, int y);
+		int getCellsExplored(void);
+		int getWallsFound(void);
+		long long getScanCount(void);
+	};
+
+	struct MotionModel // How the car drives on a speed run. Distances are in cells, so speeds are cells/s.
+	{
+		double acceleration = 8.0; // Used for braking too
+		double maxSpeed = 10.0;
+		double turnSpeed = 2.0; // Speed at the start and end of every straight, since the car has to slow down to turn
+		double turnTime = 0.3; // Time spent turning 90 degrees on the spot
+		double getStraightTime(int cells); // Fastest time along a straight of this many cells
+	};
+
+	class SpeedRunPlanner : public PathSolver // Time-optimal route over (cell, heading) states, where each edge is a turn followed by a straight run
+	{
+	private:
+		MotionModel motionModel;
+		PassabilityMap* passability;
+		WallSensor* sensor;
+		double plannedTime;
+		bool canUse(int x, int y); // Open, and if we're working from sensor data, actually seen
+		void findFastestPath(void);
+	public:
+		SpeedRunPlanner(Maze* maze, PassabilityMap* knownMap = NULL, WallSensor* sensor = NULL, MotionModel motionModel = MotionModel()); // No map means plan on the real maze
+		~SpeedRunPlanner(void);
+		double getPlannedTime(void);
+	};
+
+	class ExploreThenSpeedRun : public MazeSolver // Explores with FloodFill until it reaches the goal, then goes back to the start and does a speed run on what it learned
+	{
+	private:
+		Maze* parentMaze;
+		FloodFill* explorer;
+		SpeedRunPlanner* speedRun;
+		MotionModel motionModel;
+	public:
+		ExploreThenSpeedRun(Maze* maze, MotionModel motionModel = MotionModel());
+		~ExploreThenSpeedRun(void);
+		void MoveToNext(void);
+	};
+
+	// Headings used by the constant-memory solvers, in the same order as the neighbour offsets elsewhere. With Y pointing up the
+	// screen, turning left is +1 and turning right is +3 (mod 4).
+	enum Heading { HEADING_WEST = 0, HEADING_SOUTH = 1, HEADING_EAST = 2, HEADING_NORTH = 3 };
+
+	class WallFollower : public MazeSolver // Keeps one hand on the wall. Needs nothing but its heading, but can circle forever if the goal isn't on a wall it reaches.
+	{
+	private:
+		Maze* parentMaze;
+		int heading;
+		bool leftHand;
+	public:
+		WallFollower(Maze* maze, bool leftHand = true, int heading = HEADING_EAST);
+		void MoveToNext(void);
+	};
+
+	class Pledge : public MazeSolver // Heads in one preferred direction and only follows walls until its net turning is back to zero
+	{
+	private:
+		Maze* parentMaze;
+		int heading;
+		int preferredHeading;
+		int turnCount; // Net quarter turns while following a wall: left is +1, right is -1
+		bool followingWall;
+		bool tryMove(int direction);
+	public:
+		Pledge(Maze* maze, int preferredHeading = -1); // -1 heads along whichever axis the nearest goal is furthest along from the start
+		void MoveToNext(void);
+	};
+
+	class Tremaux : public MazeSolver // Trémaux's algorithm with the marks on cells, packed four to a byte. Handles loops, and only ever looks at the walls beside the car.
+	{
+	private:
+		Maze* parentMaze;
+		std::vector<uint8_t> marks; // 2 bits per space: 0 = unvisited, 1 = on the current path (marked once), 2 = dead (marked twice)
+		int getMark(int x, int y);
+		void setMark(int x, int y, int mark);
+		bool touchesPathElsewhere(int x, int y, int fromX, int fromY); // True if (x, y) is next to a path cell other than the one we'd come from
+	public:
+		Tremaux(Maze* maze);
+		void MoveToNext(void);
+		int getMemoryUsage(void); // Bytes of marks
+	};
+
+	class JumpPointSearch : public PathSolver // A* over jump points only. Straight runs are skipped with word-at-a-time scans of a PassabilityMap.
+	{
+	private:
+		PassabilityMap passability;
+		PassabilityMap goals; // Set for every goal space, so they can be picked out of a row a word at a time
+		int jumpHorizontal(int x, int y, int xDirection);
+		int jumpVertical(int x, int y, int yDirection);
 		void findShortestPath(void);
 	public:
+		JumpPointSearch(Maze* maze);
+	};
+
+	class JunctionGraph // The maze with every corridor collapsed into one weighted edge. Vertices are junctions, dead ends and any cells passed to the constructor.
+	{
+	public:
+		struct Edge
+		{
+			int target; // Vertex at the other end of the corridor
+			int length; // Number of moves along the corridor
+			int direction; // Direction of the first move out of the source cell (0: -X, 1: -Y, 2: +X, 3: +Y)
+		};
+	private:
+		Maze* parentMaze;
+		std::vector<int> vertexIndex; // Flat cell index -> vertex number, or -1 for corridor cells and walls
+		std::vector<int> vertexCells; // Vertex number -> flat cell index
+		std::vector<int> edgeStart; // Edges of vertex v are edges[edgeStart[v]] to edges[edgeStart[v + 1] - 1]
+		std::vector<Edge> edges;
+		int countOpenNeighbours(int x, int y);
+	public:
+		JunctionGraph(Maze* maze, std::vector<std::pair<int, int>> extraVertices);
+		int getVertexCount(void);
+		int getEdgeCount(void);
+		int getVertex(int x, int y); // -1 if (x, y) isn't a vertex
+		int getCell(int vertex);
+		Edge* edgesBegin(int vertex);
+		Edge* edgesEnd(int vertex);
+		void appendCorridor(int vertex, Edge& edge, std::vector<int>& path); // Adds the cells of an edge, excluding the source and including the target
+	};
+
+	class ContractedAStar : public PathSolver // A* over a JunctionGraph, then expands the junction route back out to single cells
+	{
+	private:
+		JunctionGraph graph;
+		void findShortestPath(void);
+	public:
+		ContractedAStar(Maze* maze);
+	};
+
+	class DeadEndFiller // Repeatedly walls off dead ends until only cells that can lie on a route between the kept cells remain
+	{
+	private:
+		PassabilityMap mask;
+		int filledCells;
+	public:
+		DeadEndFiller(Maze* maze, std::vector<std::pair<int, int>> keptCells);
+		PassabilityMap* getMask(void);
+		int getFilledCells(void);
+	};
+
+	class DeadEndFilling : public PathSolver // Fills dead ends, then BFS over what's left. In a perfect maze what's left is the route itself.
+	{
+	private:
+		DeadEndFiller filler;
+		void findShortestPath(void);
+	public:
+		DeadEndFilling(Maze* maze);
+	};
+
+	class DistanceFieldSolver : public MazeSolver // Steps downhill on the maze's cached goal distance field, so it works from wherever the car is
+	{
+	private:
+		Maze* parentMaze;
+	public:
+		DistanceFieldSolver(Maze* maze);
 		void MoveToNext(void);
-		AStar(Maze* maze);
-		Node* getClosestedUnvisitedNode(void);
+	};
+
+	class DStarLite : public MazeSolver, public MazeListener // Plans backwards from the goal and, when a space changes, only repairs the part of the plan that depended on it
+	{
+	private:
+		Maze* parentMaze;
+		int xSize;
+		int ySize;
+		int startIndex;
+		int lastStartIndex; // Where the car was the last time keyModifier was brought up to date
+		int keyModifier;
+		int examinedNodes;
+		bool replanNeeded;
+		std::vector<int> g; // Current distance estimate to the goal
+		std::vector<int> rhs; // One-step lookahead on g. A vertex is inconsistent, and queued, while the two differ.
+		std::vector<bool> inQueue;
+		std::vector<std::pair<int, int>> queuedKey; // The key a vertex's live queue entry was pushed with, older entries are skipped
+		std::priority_queue<std::pair<std::pair<int, int>, int>, std::vector<std::pair<std::pair<int, int>, int>>, std::greater<std::pair<std::pair<int, int>, int>>> openList;
+		int heuristic(int from, int to);
+		std::pair<int, int> calculateKey(int index);
+		void queueVertex(int index);
+		void updateVertex(int index);
+		void computeShortestPath(void);
+	public:
+		DStarLite(Maze* maze);
+		~DStarLite(void);
+		void MoveToNext(void);
+		void spaceChanged(int x, int y);
+		int getExaminedNodes(void);
+	};
+
+	class HierarchicalAStar : public PathSolver, public MazeListener // HPA*: A* over cluster entrances first, then plain searches inside each cluster along the chosen corridor
+	{
+	private:
+		struct Cluster
+		{
+			int x1, y1, x2, y2; // Inclusive bounds
+			std::vector<int> entrances; // Cell of each abstract node in this cluster. A corner cell can appear twice, once per border.
+			std::vector<int> partners; // The cell across the border each entrance leads to
+			std::vector<int> distances; // entrances.size() squared, shortest distance inside the cluster or -1 if there's no way
+			bool dirty;
+		};
+		int clusterSize;
+		int clustersX;
+		int clustersY;
+		std::vector<Cluster> clusters;
+		bool replanNeeded;
+		int rebuildCount;
+		int getClusterOf(int x, int y);
+		void addBorderEntrances(Cluster& cluster, int x, int y, int runX, int runY, int length, int outsideX, int outsideY);
+		void rebuildCluster(int clusterIndex);
+		void searchCluster(int clusterIndex, const std::vector<int>& fromCells, std::vector<int>& distances, std::vector<int>& previous); // BFS that stays inside the cluster, indexed by local cell
+		int getLocalIndex(Cluster& cluster, int cell);
+		void findPath(int startX, int startY);
+	public:
+		HierarchicalAStar(Maze* maze, int clusterSize = 16);
+		~HierarchicalAStar(void);
+		void MoveToNext(void);
+		void spaceChanged(int x, int y); // Marks the cluster (and any neighbour sharing that border) dirty, they're rebuilt before the next plan
+		int getClusterRebuildCount(void);
+	};
+
+	class TreeDistanceIndex // Roots the maze's spanning forest once, then answers distance queries with an LCA lookup. Only exact when the maze is perfect.
+	{
+	private:
+		static const int BLOCK_SIZE = 16;
+		int ySize;
+		std::vector<int> parent; // Flat cell index -> parent in the tree, -1 for roots, walls and cells never reached
+		std::vector<int> depth; // -1 for walls
+		std::vector<int> component; // Which tree of the forest a cell is in, -1 for walls
+		std::vector<int> firstVisit; // Position of each cell's first appearance in the Euler tour
+		std::vector<int> eulerCells;
+		std::vector<int> eulerDepths;
+		std::vector<std::vector<int>> blockTable; // blockTable[k][b] is the tour position of the shallowest cell in blocks b to b + 2^k - 1
+		int extraEdges; // Edges that close a loop. Zero means the maze is perfect (within each component).
+		int shallowerOf(int a, int b);
+		int scanRange(int from, int to); // Shallowest tour position in [from, to]
+	public:
+		TreeDistanceIndex(Maze* maze);
+		bool isPerfect(void);
+		int getLowestCommonAncestor(int cellA, int cellB); // Flat cell indices. -1 if they aren't connected.
+		int getDistance(int startX, int startY, int goalX, int goalY); // -1 if they aren't connected
+		std::vector<int> getPath(int startX, int startY, int goalX, int goalY); // Flat cell indices from start to goal inclusive, empty if they aren't connected
+	};
+
+	class TreePathSolver : public PathSolver // Follows the route read straight off a TreeDistanceIndex
+	{
+	private:
+		TreeDistanceIndex* index;
+		bool ownsIndex;
+	public:
+		TreePathSolver(Maze* maze, TreeDistanceIndex* index = NULL); // Builds its own index if none is shared
+		~TreePathSolver(void);
 	};
 
 	class Node
@@ -138,6 +817,7 @@ namespace MazeSolve
 		Node* previousNode;
 		std::vector<Node*> neighbours;
 		int weight;
+		int cost;
 		int distance;
 		int x;
 		int y;
@@ -150,8 +830,9 @@ namespace MazeSolve
 		Node* getNearestNeighbour(void);
 		Node* getPrevious(void);
 		void setPrevious(Node* newPrevious);
-		Node(int X, int Y, int weight = 0);
+		Node(int X, int Y, int weight = 0, int cost = 1);
 		int getWeight(void);
+		int getCost(void); // Cost of moving onto this node, from the space's terrain
 
 	};
 
@@ -162,9 +843,17 @@ namespace MazeSolve
 	protected:
 		bool Passable;
 		std::string Colour;
+		int Cost; // What it costs to drive onto this space, plain floor is 1
 	public:
 		bool GetPassable(void);
 		std::string GetColour(void);
+		int GetCost(void);
+	};
+
+	enum Connectivity
+	{
+		FOUR_CONNECTED,
+		EIGHT_CONNECTED // Diagonal moves as well, but only when both spaces either side of the diagonal are open, so the car never clips the corner of a wall
 	};
 
 	class Maze
@@ -174,13 +863,28 @@ namespace MazeSolve
 		MazeGenerator* mazeGenerator;
 		int xSize;
 		int ySize;
-		int goalX;
+		int startX; // Where the car starts, (0,0) unless setStart moves it
+		int startY;
+		int goalX; // The primary goal, the one passed to the constructor
 		int goalY;
+		std::vector<std::pair<int, int>> goals; // Every goal, primary first. A goal that's been built over stays listed but isn't passable.
+		std::vector<bool> goalSpaces; // Flat index, so isGoal doesn't have to search the list
 		Car* car;
+		std::vector<uint16_t> goalDistances; // Moves from each space to the nearest goal (x * ySize + y), UNREACHABLE_DISTANCE if it can't reach one
+		bool goalDistancesValid;
+		std::vector<MazeListener*> listeners;
+		Connectivity connectivity;
+		void buildGoalDistances(void);
 	public:
+		static constexpr uint16_t UNREACHABLE_DISTANCE = 0xFFFF; // Same width as the flood values, half the memory of an int field
+		static const int STRAIGHT_MOVE_COST = 10; // In EIGHT_CONNECTED mode move costs are the tile cost times these, 14 / 10 being close to sqrt(2)
+		static const int DIAGONAL_MOVE_COST = 14;
 		~Maze(void);
 		Maze(int xSize, int ySize, int goalX, int goalY);
 		Space GetSpace(int x, int y);
+		bool isPassable(int x, int y); // Cheap bounds-checked passability test, doesn't copy the Space or throw
+		int getCost(int x, int y); // Cost of driving onto a space, without copying it
+		NeighbourList getOpenNeighbours(int x, int y); // In -X, -Y, +X, +Y order
 		void SetSpace(int x, int y, Space* newSpace);
 		void Step(void);
 		void setGenerator(MazeGenerator* mazeGenerator);
@@ -189,8 +893,23 @@ namespace MazeSolve
 		Car* GetCar(void);
 		int getXSize(void);
 		int getYSize(void);
+		void setStart(int x, int y); // Also puts the car there. Solvers plan from wherever the start is when they're made, so set it first.
+		int getStartX(void);
+		int getStartY(void);
 		int getGoalX(void);
 		int getGoalY(void);
+		void addGoal(int x, int y); // Solvers stop at whichever goal is nearest, e.g. any of the four centre spaces of a micromouse maze
+		bool isGoal(int x, int y);
+		int getGoalCount(void);
+		std::vector<std::pair<int, int>> getGoals(void);
+		std::vector<int> getGoalIndices(void); // Flat indices of the passable goals, for seeding searches
+		int getGoalHeuristic(int x, int y); // Manhattan distance to the nearest goal, walls ignored
+		std::vector<uint16_t>* getGoalDistances(void); // Built on first use and rebuilt after the maze changes
+		int getGoalDistance(int x, int y); // -1 if no goal can be reached
+		void addListener(MazeListener* listener);
+		void removeListener(MazeListener* listener);
+		void setConnectivity(Connectivity connectivity); // Dijkstra and AStar honour this, the other solvers only ever make straight moves
+		Connectivity getConnectivity(void);
 	};
 
 	class Car
@@ -205,6 +924,7 @@ namespace MazeSolve
 		Car(Maze* maze);
 		void SetPos(int x, int y);
 		void setMazeSolver(MazeSolver* mazeSolver);
+		MazeSolver* getMazeSolver(void);
 		int GetX(void);
 		int GetY(void);
 		void MoveToNext(void);
@@ -228,4 +948,185 @@ namespace MazeSolve
 	public:
 		Goal();
 	};
+
+	class Mud : public Space
+	{
+	public:
+		Mud();
+	};
+
+	class Ramp : public Space
+	{
+	public:
+		Ramp();
+	};
+
+	class SlowZone : public Space
+	{
+	public:
+		SlowZone(int cost = 3);
+	};
+
+	inline uint64_t readCycleCounter(void) // Time stamp counter where there is one, nanoseconds otherwise
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	// FloodFill for the car's controller. Everything is sized at compile time (no heap, no exceptions), it explores using only the walls
+	// beside the car, and a reflood never pops more than RefloodBudget spaces per MoveToNext - if it needs more, the car waits and the
+	// reflood carries on next call. Uses the same runReflood as FloodFill. If the maze isn't Width x Height the car never moves.
+	template <int Width, int Height, int RefloodBudget = Width * Height>
+	class FloodFillFixed : public MazeSolver
+	{
+	private:
+		static constexpr int CELLS = Width * Height;
+		static_assert(CELLS <= 0xFFFF, "Cell indices have to fit in the 16-bit queue");
+		Maze* parentMaze;
+		bool sizeMatches;
+		std::bitset<CELLS> goalSpaces;
+		std::array<uint16_t, CELLS> floodValues;
+		std::array<uint16_t, CELLS> refloodQueue;
+		std::bitset<CELLS> queued;
+		std::bitset<CELLS> knownWalls; // Unseen spaces are assumed open
+		int queueHead;
+		int queueSize;
+		long long floodUpdateCount;
+		uint64_t lastMoveCycles;
+		uint64_t worstMoveCycles;
+		bool isOpen(int x, int y) const noexcept
+		{
+			return x >= 0 && y >= 0 && x < Width && y < Height && !knownWalls[x * Height + y];
+		}
+		void scan(int x, int y) noexcept // Simulated wall sensor, the four spaces beside the car
+		{
+			const int xOffsets[4] = { -1, 0, 1, 0 };
+			const int yOffsets[4] = { 0, -1, 0, 1 };
+			for (int direction = 0; direction < 4; direction++)
+			{
+				int neighbourX = x + xOffsets[direction];
+				int neighbourY = y + yOffsets[direction];
+				if (neighbourX < 0 || neighbourY < 0 || neighbourX >= Width || neighbourY >= Height) continue;
+				knownWalls[neighbourX * Height + neighbourY] = !parentMaze->isPassable(neighbourX, neighbourY);
+			}
+		}
+		void finishMove(uint64_t startCycles) noexcept
+		{
+			lastMoveCycles = readCycleCounter() - startCycles;
+			worstMoveCycles = std::max(worstMoveCycles, lastMoveCycles);
+		}
+	public:
+		FloodFillFixed(Maze* maze) noexcept
+		{
+			this->parentMaze = maze;
+			this->parentCar = maze->GetCar();
+			this->sizeMatches = maze->getXSize() == Width && maze->getYSize() == Height;
+			this->queueHead = 0;
+			this->queueSize = 0;
+			this->floodUpdateCount = 0;
+			this->lastMoveCycles = 0;
+			this->worstMoveCycles = 0;
+			for (int i = 0; i < Width; i++) // Manhattan distance from the nearest goal, same as FloodFill
+			{
+				for (int j = 0; j < Height; j++)
+				{
+					floodValues[i * Height + j] = (uint16_t)maze->getGoalHeuristic(i, j);
+					goalSpaces[i * Height + j] = maze->isGoal(i, j);
+				}
+			}
+		}
+		void MoveToNext(void) noexcept
+		{
+			uint64_t startCycles = readCycleCounter();
+			int x = parentCar->GetX();
+			int y = parentCar->GetY();
+			if (!sizeMatches || x < 0 || y < 0 || x >= Width || y >= Height || goalSpaces[x * Height + y]) return finishMove(startCycles);
+			scan(x, y);
+			int index = x * Height + y;
+			if (queueSize == 0)
+			{
+				uint16_t lowest = FloodFill::UNREACHABLE_FLOOD;
+				if (isOpen(x - 1, y)) lowest = std::min(lowest, floodValues[index - Height]);
+				if (isOpen(x + 1, y)) lowest = std::min(lowest, floodValues[index + Height]);
+				if (isOpen(x, y - 1)) lowest = std::min(lowest, floodValues[index - 1]);
+				if (isOpen(x, y + 1)) lowest = std::min(lowest, floodValues[index + 1]);
+				if (lowest >= floodValues[index]) // Stuck in a dip, start a reflood from here
+				{
+					queueHead = 0;
+					queueSize = 1;
+					refloodQueue[0] = (uint16_t)index;
+					queued[index] = true;
+				}
+			}
+			if (queueSize > 0)
+			{
+				runReflood(floodValues, refloodQueue, queueHead, queueSize, queued, Width, Height, [this](int index) { return goalSpaces[index]; }, RefloodBudget,
+					[this](int cellX, int cellY) { return isOpen(cellX, cellY); }, floodUpdateCount);
+				if (queueSize > 0) return finishMove(startCycles); // Out of budget for this tick
+			}
+			const int xOffsets[4] = { -1, 0, 1, 0 };
+			const int yOffsets[4] = { 0, -1, 0, 1 };
+			int best = -1;
+			for (int direction = 0; direction < 4; direction++)
+			{
+				int neighbourX = x + xOffsets[direction];
+				int neighbourY = y + yOffsets[direction];
+				if (!isOpen(neighbourX, neighbourY) || floodValues[neighbourX * Height + neighbourY] >= floodValues[index]) continue;
+				if (best == -1 || floodValues[neighbourX * Height + neighbourY] < floodValues[best]) best = neighbourX * Height + neighbourY;
+			}
+			if (best != -1) parentCar->SetPos(best / Height, best % Height);
+			finishMove(startCycles);
+		}
+		int GetFloodValue(int x, int y) const noexcept
+		{
+			return (x >= 0 && y >= 0 && x < Width && y < Height) ? floodValues[x * Height + y] : FloodFill::UNREACHABLE_FLOOD;
+		}
+		uint64_t getLastMoveCycles(void) const noexcept
+		{
+			return this->lastMoveCycles;
+		}
+		uint64_t getWorstMoveCycles(void) const noexcept
+		{
+			return this->worstMoveCycles;
+		}
+		long long getFloodUpdateCount(void) const noexcept
+		{
+			return this->floodUpdateCount;
+		}
+	};
+
+	// Runs FloodFillFixed<Width, Height> to the centre of mazeCount generated mazes and prints the cycles spent per MoveToNext, so the
+	// worst case can be checked against the controller's control loop budget.
+	template <int Width, int Height>
+	void benchmarkFloodFillFixed(int mazeCount)
+	{
+		uint64_t worstCycles = 0;
+		uint64_t totalCycles = 0;
+		long long totalMoves = 0;
+		int unsolved = 0;
+		for (int i = 0; i < mazeCount; i++)
+		{
+			Maze* maze = new Maze(Width, Height, Width / 2, Height / 2);
+			maze->setGenerator(new RecursiveSubdivider(maze));
+			maze->GetCar()->SetPos(0, 0);
+			FloodFillFixed<Width, Height>* solver = new FloodFillFixed<Width, Height>(maze);
+			maze->setSolver(solver);
+			int moves = 0;
+			while ((maze->GetCar()->GetX() != Width / 2 || maze->GetCar()->GetY() != Height / 2) && moves < Width * Height * 16)
+			{
+				maze->Step();
+				totalCycles += solver->getLastMoveCycles();
+				moves++;
+			}
+			if (moves == Width * Height * 16) unsolved++;
+			worstCycles = std::max(worstCycles, solver->getWorstMoveCycles());
+			totalMoves += moves;
+			delete maze;
+		}
+		std::cout << "FloodFillFixed<" << Width << "," << Height << ">: " << mazeCount << " mazes, " << totalMoves << " moves, " << unsolved << " unsolved" << std::endl;
+		std::cout << "Mean cycles per move: " << (totalMoves > 0 ? totalCycles / totalMoves : 0) << ", worst: " << worstCycles << std::endl;
+	}
 }
\ No newline at end of file